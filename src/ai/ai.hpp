@@ -53,6 +53,11 @@ public:
 	 */
 	static void GameLoop();
 
+	/**
+	 * Claim the shares of the per-tick opcode budget of the AIs which run in this tick.
+	 */
+	static void ScheduleOpcodeBudget();
+
 	/**
 	 * Get the current AI tick.
 	 */
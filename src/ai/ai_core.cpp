@@ -66,15 +66,28 @@
 	return;
 }
 
+/**
+ * Check whether the AIs run in a frame.
+ * @param frame The AI frame counter value of the frame.
+ * @return True if the AIs run in the frame.
+ */
+static bool AreAIsRunInFrame(uint frame)
+{
+	/* If we are in networking, only servers run the AIs, and that only if it is allowed */
+	if (_networking && (!_network_server || !_settings_game.ai.ai_in_multiplayer)) return false;
+
+	/* The speed with which AIs go, is limited by the 'competitor_speed' */
+	assert(_settings_game.difficulty.competitor_speed <= 4);
+	return (frame & ((1 << (4 - _settings_game.difficulty.competitor_speed)) - 1)) == 0;
+}
+
 /* static */ void AI::GameLoop()
 {
 	/* If we are in networking, only servers run this function, and that only if it is allowed */
 	if (_networking && (!_network_server || !_settings_game.ai.ai_in_multiplayer)) return;
 
-	/* The speed with which AIs go, is limited by the 'competitor_speed' */
 	AI::frame_counter++;
-	assert(_settings_game.difficulty.competitor_speed <= 4);
-	if ((AI::frame_counter & ((1 << (4 - _settings_game.difficulty.competitor_speed)) - 1)) != 0) return;
+	if (!AreAIsRunInFrame(AI::frame_counter)) return;
 
 	Backup<CompanyID> cur_company(_current_company, FILE_LINE);
 	for (const Company *c : Company::Iterate()) {
@@ -97,6 +110,16 @@
 	}
 }
 
+/* static */ void AI::ScheduleOpcodeBudget()
+{
+	/* GameLoop only advances the frame counter when the AIs may run at all. */
+	if (!AreAIsRunInFrame(AI::frame_counter + 1)) return;
+
+	for (const Company *c : Company::Iterate()) {
+		if (c->is_ai) c->ai_instance->ScheduleOpcodeBudget();
+	}
+}
+
 /* static */ uint AI::GetTick()
 {
 	return AI::frame_counter;
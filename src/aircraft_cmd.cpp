@@ -31,6 +31,7 @@
 #include "company_func.h"
 #include "effectvehicle_func.h"
 #include "station_base.h"
+#include "station_kdtree.h"
 #include "engine_base.h"
 #include "core/random_func.hpp"
 #include "core/backup_type.hpp"
@@ -83,8 +84,8 @@ void Aircraft::UpdateDeltaXY()
 }
 
 static bool AirportMove(Aircraft *v, const AirportFTAClass *apc);
-static bool AirportSetBlocks(Aircraft *v, const AirportFTA *current_pos, const AirportFTAClass *apc);
-static bool AirportHasBlock(Aircraft *v, const AirportFTA *current_pos, const AirportFTAClass *apc);
+static bool AirportSetBlocks(Aircraft *v, const AirportFTA *current_pos);
+static bool AirportHasBlock(Aircraft *v, const AirportFTA *current_pos);
 static bool AirportFindFreeTerminal(Aircraft *v, const AirportFTAClass *apc);
 static bool AirportFindFreeHelipad(Aircraft *v, const AirportFTAClass *apc);
 static void CrashAirplane(Aircraft *v);
@@ -142,30 +143,45 @@ static StationID FindNearestHangar(const Aircraft *v)
 		}
 	}
 
-	for (const Station *st : Station::Iterate()) {
-		if (!IsInfraUsageAllowed(VEH_AIRCRAFT, v->owner, st->owner) || !(st->facilities & FACIL_AIRPORT) || !st->airport.HasHangar()) continue;
+	auto check_station = [&](StationID id) {
+		const Station *st = Station::Get(id);
+		if (!IsInfraUsageAllowed(VEH_AIRCRAFT, v->owner, st->owner) || !st->airport.HasHangar()) return;
 
 		const AirportFTAClass *afc = st->airport.GetFTA();
 
 		/* don't crash the plane if we know it can't land at the airport */
-		if ((afc->flags & AirportFTAClass::SHORT_STRIP) && (avi->subtype & AIR_FAST) && !_cheats.no_jetcrash.value) continue;
+		if ((afc->flags & AirportFTAClass::SHORT_STRIP) && (avi->subtype & AIR_FAST) && !_cheats.no_jetcrash.value) return;
 
 		/* the plane won't land at any helicopter station */
-		if (!(afc->flags & AirportFTAClass::AIRPLANES) && (avi->subtype & AIR_CTOL)) continue;
+		if (!(afc->flags & AirportFTAClass::AIRPLANES) && (avi->subtype & AIR_CTOL)) return;
 
 		/* Check if our last and next destinations can be reached from the depot airport. */
 		if (max_range != 0) {
 			uint last_dist = (last_dest != nullptr && last_dest->airport.tile != INVALID_TILE) ? DistanceSquare(st->airport.tile, last_dest->airport.tile) : 0;
 			uint next_dist = (next_dest != nullptr && next_dest->airport.tile != INVALID_TILE) ? DistanceSquare(st->airport.tile, next_dest->airport.tile) : 0;
-			if (last_dist > max_range || next_dist > max_range) continue;
+			if (last_dist > max_range || next_dist > max_range) return;
 		}
 
 		/* v->tile can't be used here, when aircraft is flying v->tile is set to 0 */
 		uint distance = DistanceSquare(vtile, st->airport.tile);
-		if (distance < best || index == INVALID_STATION) {
+		/* Of airports at the same distance the one with the lowest index is chosen, whatever the order of the search. */
+		if (index == INVALID_STATION || distance < best || (distance == best && id < index)) {
 			best = distance;
-			index = st->index;
+			index = id;
 		}
+	};
+
+	/* Search squares of growing size around the aircraft. Any airport
+	 * outside of a square is further away than the radius of the square. */
+	const uint max_radius = std::max(MapSizeX(), MapSizeY());
+	for (uint radius = 16;; radius *= 2) {
+		uint32 x1 = (uint32)std::max<int>(0, TileX(vtile) - radius);
+		uint32 x2 = (uint32)std::min<int>(TileX(vtile) + radius + 1, MapSizeX());
+		uint32 y1 = (uint32)std::max<int>(0, TileY(vtile) - radius);
+		uint32 y2 = (uint32)std::min<int>(TileY(vtile) + radius + 1, MapSizeY());
+		_airport_kdtree.FindContained(x1, y1, x2, y2, check_station);
+
+		if ((index != INVALID_STATION && best <= radius * radius) || radius >= max_radius) break;
 	}
 	return index;
 }
@@ -1606,7 +1622,7 @@ static void AircraftEventHandler_InHangar(Aircraft *v, const AirportFTAClass *ap
 	}
 
 	/* if the block of the next position is busy, stay put */
-	if (AirportHasBlock(v, &apc->layout[v->pos], apc)) return;
+	if (AirportHasBlock(v, &apc->layout[v->pos])) return;
 
 	/* We are already at the target airport, we need to find a terminal */
 	if (v->current_order.GetDestination() == v->targetairport) {
@@ -1649,7 +1665,7 @@ static void AircraftEventHandler_AtTerminal(Aircraft *v, const AirportFTAClass *
 	if (v->current_order.IsType(OT_NOTHING)) return;
 
 	/* if the block of the next position is busy, stay put */
-	if (AirportHasBlock(v, &apc->layout[v->pos], apc)) return;
+	if (AirportHasBlock(v, &apc->layout[v->pos])) return;
 
 	/* airport-road is free. We either have to go to another airport, or to the hangar
 	 * ---> start moving */
@@ -1738,7 +1754,7 @@ static void AircraftEventHandler_Flying(Aircraft *v, const AirportFTAClass *apc)
 				 * hack for speed thingie */
 				uint16 tcur_speed = v->cur_speed;
 				uint16 tsubspeed = v->subspeed;
-				if (!AirportHasBlock(v, current, apc)) {
+				if (!AirportHasBlock(v, current)) {
 					v->state = landingtype; // LANDING / HELILANDING
 					if (v->state == HELILANDING) SetBit(v->flags, VAF_HELI_DIRECT_DESCENT);
 					/* it's a bit dirty, but I need to set position to next position, otherwise
@@ -1780,7 +1796,7 @@ static void AircraftEventHandler_HeliLanding(Aircraft *v, const AirportFTAClass
 static void AircraftEventHandler_EndLanding(Aircraft *v, const AirportFTAClass *apc)
 {
 	/* next block busy, don't do a thing, just wait */
-	if (AirportHasBlock(v, &apc->layout[v->pos], apc)) return;
+	if (AirportHasBlock(v, &apc->layout[v->pos])) return;
 
 	/* if going to terminal (OT_GOTO_STATION) choose one
 	 * 1. in case all terminals are busy AirportFindFreeTerminal() returns false or
@@ -1796,7 +1812,7 @@ static void AircraftEventHandler_EndLanding(Aircraft *v, const AirportFTAClass *
 static void AircraftEventHandler_HeliEndLanding(Aircraft *v, const AirportFTAClass *apc)
 {
 	/*  next block busy, don't do a thing, just wait */
-	if (AirportHasBlock(v, &apc->layout[v->pos], apc)) return;
+	if (AirportHasBlock(v, &apc->layout[v->pos])) return;
 
 	/* if going to helipad (OT_GOTO_STATION) choose one. If airport doesn't have helipads, choose terminal
 	 * 1. in case all terminals/helipads are busy (AirportFindFreeHelipad() returns false) or
@@ -1886,53 +1902,35 @@ static bool AirportMove(Aircraft *v, const AirportFTAClass *apc)
 
 	v->previous_pos = v->pos; // save previous location
 
-	/* there is only one choice to move to */
-	if (current->next == nullptr) {
-		if (AirportSetBlocks(v, current, apc)) {
+	/* take the only choice to move to, or the first one that matches our heading */
+	current = apc->GetTransition(v->pos, v->state);
+	if (current != nullptr) {
+		if (AirportSetBlocks(v, current)) {
 			v->pos = current->next_position;
 			UpdateAircraftCache(v);
 		} // move to next position
 		return false;
 	}
 
-	/* there are more choices to choose from, choose the one that
-	 * matches our heading */
-	do {
-		if (v->state == current->heading || current->heading == TO_ALL) {
-			if (AirportSetBlocks(v, current, apc)) {
-				v->pos = current->next_position;
-				UpdateAircraftCache(v);
-			} // move to next position
-			return false;
-		}
-		current = current->next;
-	} while (current != nullptr);
-
 	DEBUG(misc, 0, "[Ap] cannot move further on Airport! (pos %d state %d) for vehicle %d", v->pos, v->state, v->index);
 	NOT_REACHED();
 }
 
-/** returns true if the road ahead is busy, eg. you must wait before proceeding. */
-static bool AirportHasBlock(Aircraft *v, const AirportFTA *current_pos, const AirportFTAClass *apc)
+/**
+ * returns true if the road ahead is busy, eg. you must wait before proceeding.
+ * @param v airplane that requires the operation
+ * @param current_pos element of the state machine at the position of the vehicle to move along
+ */
+static bool AirportHasBlock(Aircraft *v, const AirportFTA *current_pos)
 {
-	const AirportFTA *reference = &apc->layout[v->pos];
-	const AirportFTA *next = &apc->layout[current_pos->next_position];
-
 	/* same block, then of course we can move */
-	if (apc->layout[current_pos->position].block != next->block) {
-		const Station *st = Station::Get(v->targetairport);
-		uint64 airport_flags = next->block;
+	if (current_pos->wait_blocks == 0) return false;
 
-		/* check additional possible extra blocks */
-		if (current_pos != reference && current_pos->block != NOTHING_block) {
-			airport_flags |= current_pos->block;
-		}
-
-		if (st->airport.flags & airport_flags) {
-			v->cur_speed = 0;
-			v->subspeed = 0;
-			return true;
-		}
+	const Station *st = Station::Get(v->targetairport);
+	if (st->airport.flags & current_pos->wait_blocks) {
+		v->cur_speed = 0;
+		v->subspeed = 0;
+		return true;
 	}
 	return false;
 }
@@ -1940,45 +1938,22 @@ static bool AirportHasBlock(Aircraft *v, const AirportFTA *current_pos, const Ai
 /**
  * "reserve" a block for the plane
  * @param v airplane that requires the operation
- * @param current_pos of the vehicle in the list of blocks
- * @param apc airport on which block is requested to be set
+ * @param current_pos element of the state machine at the position of the vehicle to move along
  * @returns true on success. Eg, next block was free and we have occupied it
  */
-static bool AirportSetBlocks(Aircraft *v, const AirportFTA *current_pos, const AirportFTAClass *apc)
-{
-	const AirportFTA *next = &apc->layout[current_pos->next_position];
-	const AirportFTA *reference = &apc->layout[v->pos];
-
-	/* if the next position is in another block, check it and wait until it is free */
-	if ((apc->layout[current_pos->position].block & next->block) != next->block) {
-		uint64 airport_flags = next->block;
-		/* search for all all elements in the list with the same state, and blocks != N
-		 * this means more blocks should be checked/set */
-		const AirportFTA *current = current_pos;
-		if (current == reference) current = current->next;
-		while (current != nullptr) {
-			if (current->heading == current_pos->heading && current->block != 0) {
-				airport_flags |= current->block;
-				break;
-			}
-			current = current->next;
-		}
-
-		/* if the block to be checked is in the next position, then exclude that from
-		 * checking, because it has been set by the airplane before */
-		if (current_pos->block == next->block) airport_flags ^= next->block;
-
-		Station *st = Station::Get(v->targetairport);
-		if (st->airport.flags & airport_flags) {
-			v->cur_speed = 0;
-			v->subspeed = 0;
-			return false;
-		}
+static bool AirportSetBlocks(Aircraft *v, const AirportFTA *current_pos)
+{
+	/* the blocks to check and occupy only depend on the element, see AirportPrecomputeBlocks */
+	if (current_pos->reserve_blocks == 0) return true;
 
-		if (next->block != NOTHING_block) {
-			SETBITS(st->airport.flags, airport_flags); // occupy next block
-		}
+	Station *st = Station::Get(v->targetairport);
+	if (st->airport.flags & current_pos->reserve_blocks) {
+		v->cur_speed = 0;
+		v->subspeed = 0;
+		return false;
 	}
+
+	SETBITS(st->airport.flags, current_pos->occupy_blocks); // occupy next block
 	return true;
 }
 
@@ -67,6 +67,8 @@ AIRPORT_GENERIC(dummy, nullptr, 0, AirportFTAClass::ALL, 0)
 
 static uint16 AirportGetNofElements(const AirportFTAbuildup *apFA);
 static AirportFTA *AirportBuildAutomata(uint nofelements, const AirportFTAbuildup *apFA);
+static void AirportPrecomputeBlocks(uint nofelements, AirportFTA *layout);
+static const AirportFTA **AirportBuildTransitions(uint nofelements, const AirportFTA *layout);
 
 
 /**
@@ -127,6 +129,10 @@ AirportFTAClass::AirportFTAClass(
 {
 	/* Build the state machine itself */
 	this->layout = AirportBuildAutomata(this->nofelements, apFA);
+
+	/* The state machine never changes, so precompute the decisions aircraft take on it */
+	AirportPrecomputeBlocks(this->nofelements, this->layout);
+	this->transitions = AirportBuildTransitions(this->nofelements, this->layout);
 }
 
 AirportFTAClass::~AirportFTAClass()
@@ -140,6 +146,7 @@ AirportFTAClass::~AirportFTAClass()
 		}
 	}
 	free(layout);
+	free(transitions);
 }
 
 /**
@@ -199,6 +206,81 @@ static AirportFTA *AirportBuildAutomata(uint nofelements, const AirportFTAbuildu
 	return FAutomata;
 }
 
+/**
+ * Precompute the blocks which have to be checked and occupied to move along each element of the FTA.
+ * The blocks of an element are used by aircraft at the position of the element, so they only depend on the element and its position.
+ * @param nofelements The number of elements in the FTA.
+ * @param layout The FTA.
+ */
+static void AirportPrecomputeBlocks(uint nofelements, AirportFTA *layout)
+{
+	for (uint i = 0; i < nofelements; i++) {
+		const AirportFTA *reference = &layout[i];
+		for (AirportFTA *current_pos = &layout[i]; current_pos != nullptr; current_pos = current_pos->next) {
+			assert(current_pos->next_position < nofelements);
+			const AirportFTA *next = &layout[current_pos->next_position];
+
+			/* same block, then of course we can move */
+			current_pos->wait_blocks = 0;
+			if (layout[current_pos->position].block != next->block) {
+				current_pos->wait_blocks = next->block;
+
+				/* check additional possible extra blocks */
+				if (current_pos != reference && current_pos->block != NOTHING_block) {
+					current_pos->wait_blocks |= current_pos->block;
+				}
+			}
+
+			/* if the next position is in another block, check it and wait until it is free */
+			current_pos->reserve_blocks = 0;
+			if ((layout[current_pos->position].block & next->block) != next->block) {
+				uint64 airport_flags = next->block;
+				/* search for all all elements in the list with the same state, and blocks != N
+				 * this means more blocks should be checked/set */
+				const AirportFTA *current = current_pos;
+				if (current == reference) current = current->next;
+				while (current != nullptr) {
+					if (current->heading == current_pos->heading && current->block != 0) {
+						airport_flags |= current->block;
+						break;
+					}
+					current = current->next;
+				}
+
+				/* if the block to be checked is in the next position, then exclude that from
+				 * checking, because it has been set by the airplane before */
+				if (current_pos->block == next->block) airport_flags ^= next->block;
+
+				current_pos->reserve_blocks = airport_flags;
+			}
+			current_pos->occupy_blocks = (next->block != NOTHING_block) ? current_pos->reserve_blocks : 0;
+		}
+	}
+}
+
+/**
+ * Build the table of the element of the FTA an aircraft moves along, for each position and movement state.
+ * @param nofelements The number of elements in the FTA.
+ * @param layout The FTA.
+ * @return The transition table, indexed by position * (MAX_HEADINGS + 1) + state.
+ */
+static const AirportFTA **AirportBuildTransitions(uint nofelements, const AirportFTA *layout)
+{
+	const AirportFTA **transitions = MallocT<const AirportFTA *>(nofelements * (MAX_HEADINGS + 1));
+
+	for (uint i = 0; i < nofelements; i++) {
+		for (uint state = 0; state <= MAX_HEADINGS; state++) {
+			const AirportFTA *current = &layout[i];
+			/* when there is more than one choice, choose the first one that matches the state */
+			if (current->next != nullptr) {
+				while (current != nullptr && current->heading != state && current->heading != TO_ALL) current = current->next;
+			}
+			transitions[i * (MAX_HEADINGS + 1) + state] = current;
+		}
+	}
+	return transitions;
+}
+
 /**
  * Get the finite state machine of an airport type.
  * @param airport_type %Airport type to query FTA from. @see AirportTypes
@@ -173,8 +173,21 @@ public:
 		return &moving_data[position];
 	}
 
+	/**
+	 * Get the element of the state machine an aircraft moves along from a position.
+	 * @param position Element number of the position.
+	 * @param state Movement state of the aircraft.
+	 * @return The element to move along, or nullptr if the aircraft cannot move further.
+	 */
+	const struct AirportFTA *GetTransition(byte position, byte state) const
+	{
+		assert(position < nofelements && state <= MAX_HEADINGS);
+		return transitions[position * (MAX_HEADINGS + 1) + state];
+	}
+
 	const AirportMovingData *moving_data; ///< Movement data.
 	struct AirportFTA *layout;            ///< state machine for airport
+	const struct AirportFTA **transitions; ///< precomputed element to move along for each position and movement state, see GetTransition
 	const byte *terminals;                ///< %Array with the number of terminal groups, followed by the number of terminals in each group.
 	const byte num_helipads;              ///< Number of helipads on this airport. When 0 helicopters will go to normal terminals.
 	Flags flags;                          ///< Flags for this airport type.
@@ -190,6 +203,9 @@ DECLARE_ENUM_AS_BIT_SET(AirportFTAClass::Flags)
 struct AirportFTA {
 	AirportFTA *next;        ///< possible extra movement choices from this position
 	uint64 block;            ///< 64 bit blocks (st->airport.flags), should be enough for the most complex airports
+	uint64 wait_blocks;      ///< precomputed blocks which have to be free before moving to next_position, see AirportHasBlock
+	uint64 reserve_blocks;   ///< precomputed blocks which have to be free to reserve the move to next_position, see AirportSetBlocks
+	uint64 occupy_blocks;    ///< precomputed blocks which are occupied when reserving the move to next_position
 	byte position;           ///< the position that an airplane is at
 	byte next_position;      ///< next position from this position
 	byte heading;            ///< heading (current orders), guiding an airplane to its target on an airport
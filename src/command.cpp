@@ -12,8 +12,10 @@
 #include "error.h"
 #include "gui.h"
 #include "command_func.h"
+#include "command_profile.h"
 #include "network/network_type.h"
 #include "network/network.h"
+#include "network/network_admin.h"
 #include "genworld.h"
 #include "strings_func.h"
 #include "texteff.hpp"
@@ -31,6 +33,7 @@
 #include "settings_func.h"
 #include "signal_func.h"
 #include <array>
+#include <chrono>
 
 #include "table/strings.h"
 
@@ -631,6 +634,83 @@ char *DumpCommandLog(char *buffer, const char *last)
 	return buffer;
 }
 
+static CommandProfileEntry _command_profile[CMD_END][COMMAND_PROFILE_OTHER_COMPANY + 1]; ///< Timing per command and company.
+static std::deque<SlowCommandLogEntry> _slow_command_log; ///< Most recent commands which took longer than the slow command threshold.
+
+/**
+ * Get the accumulated timing of a command.
+ * @param cmd_id The command ID.
+ * @param company_slot The company, or #COMMAND_PROFILE_OTHER_COMPANY for commands not run by a playable company.
+ * @return The timing.
+ */
+const CommandProfileEntry &GetCommandProfileEntry(uint cmd_id, uint company_slot)
+{
+	assert(cmd_id < CMD_END && company_slot <= COMMAND_PROFILE_OTHER_COMPANY);
+	return _command_profile[cmd_id][company_slot];
+}
+
+/** Reset the accumulated command timings and the slow command log. */
+void ResetCommandProfile()
+{
+	for (auto &cmd_profile : _command_profile) {
+		for (CommandProfileEntry &entry : cmd_profile) entry = CommandProfileEntry();
+	}
+	_slow_command_log.clear();
+}
+
+/**
+ * Get the most recent commands which took longer than the slow command threshold, oldest first.
+ * @return The slow command log.
+ */
+const std::deque<SlowCommandLogEntry> &GetSlowCommandLog()
+{
+	return _slow_command_log;
+}
+
+/** Measurement of the test and execution runs of a toplevel command, recorded when it goes out of scope. */
+struct CommandProfileScope {
+	typedef std::chrono::steady_clock clock;
+
+	TileIndex tile;
+	uint32 p1;
+	uint32 p2;
+	uint64 p3;
+	uint32 cmd;
+	const char *text;
+	uint32 binary_length;
+	CompanyID company;
+	bool ran = false;                  ///< Whether the test run has been measured.
+	clock::duration test_time {};
+	clock::duration exec_time {};
+
+	CommandProfileScope(TileIndex tile, uint32 p1, uint32 p2, uint64 p3, uint32 cmd, const char *text, uint32 binary_length)
+			: tile(tile), p1(p1), p2(p2), p3(p3), cmd(cmd), text(text), binary_length(binary_length), company(_current_company) {}
+
+	~CommandProfileScope()
+	{
+		if (!this->ran) return;
+
+		uint32 test_us = (uint32)std::min<int64>(std::chrono::duration_cast<std::chrono::microseconds>(this->test_time).count(), UINT32_MAX);
+		uint32 exec_us = (uint32)std::min<int64>(std::chrono::duration_cast<std::chrono::microseconds>(this->exec_time).count(), UINT32_MAX);
+
+		CommandProfileEntry &entry = _command_profile[this->cmd & CMD_ID_MASK][this->company < MAX_COMPANIES ? (uint)this->company : COMMAND_PROFILE_OTHER_COMPANY];
+		entry.count++;
+		entry.test_time += test_us;
+		entry.exec_time += exec_us;
+		entry.max_time = std::max(entry.max_time, test_us + exec_us);
+
+		uint threshold = _settings_client.network.slow_command_threshold;
+		if (threshold == 0 || test_us + exec_us < threshold * 1000) return;
+
+		if (_slow_command_log.size() >= SLOW_COMMAND_LOG_SIZE) _slow_command_log.pop_front();
+		_slow_command_log.push_back({ _date, _date_fract, this->company, this->cmd & ~CMD_NETWORK_COMMAND, this->tile, this->p1, this->p2, this->p3,
+				(this->binary_length == 0 && this->text != nullptr) ? this->text : "", test_us, exec_us });
+		DEBUG(misc, 1, "Slow command: %s, company: %u, tile: %X (%u x %u), p1: 0x%08X, p2: 0x%08X, p3: " OTTD_PRINTFHEX64PAD ", test: %u us, exec: %u us",
+				GetCommandName(this->cmd), (uint)this->company, this->tile, TileX(this->tile), TileY(this->tile), this->p1, this->p2, this->p3, test_us, exec_us);
+		if (_network_server) NetworkAdminSlowCommand(_slow_command_log.back());
+	}
+};
+
 /*!
  * This function range-checks a cmd, and checks if the cmd is not nullptr
  *
@@ -700,6 +780,61 @@ bool IsCommandAllowedWhilePaused(uint32 cmd)
 
 static int _docommand_recursive = 0;
 
+/** Modes of the execution plan of the toplevel command. */
+enum CommandExecPlanMode {
+	CEPM_NONE,   ///< No plan is available.
+	CEPM_RECORD, ///< The test run of the toplevel command may record a plan.
+	CEPM_REPLAY, ///< The execution run of the toplevel command may replay the plan.
+};
+
+static CommandExecPlan _command_exec_plan;                 ///< Execution plan of the toplevel command.
+static CommandExecPlanMode _command_exec_plan_mode = CEPM_NONE; ///< Mode of #_command_exec_plan.
+static uint32 _command_exec_plan_cmd = CMD_END;            ///< Command ID #_command_exec_plan belongs to.
+
+/**
+ * Allow the test run of a toplevel command to record an execution plan.
+ * @param cmd The command ID.
+ */
+static void BeginCommandExecPlan(uint32 cmd)
+{
+	_command_exec_plan.data.clear();
+	_command_exec_plan.read_pos = 0;
+	_command_exec_plan.complete = false;
+	_command_exec_plan_cmd = cmd & CMD_ID_MASK;
+	_command_exec_plan_mode = (GetCommandFlags(cmd) & CMD_NO_TEST) ? CEPM_NONE : CEPM_RECORD;
+}
+
+/** Switch from the test run to the execution run of the toplevel command. */
+static void ReplayCommandExecPlan()
+{
+	_command_exec_plan_mode = (_command_exec_plan_mode == CEPM_RECORD && _command_exec_plan.complete) ? CEPM_REPLAY : CEPM_NONE;
+}
+
+/** Discard the execution plan of the toplevel command. */
+static void EndCommandExecPlan()
+{
+	_command_exec_plan_mode = CEPM_NONE;
+	_command_exec_plan.data.clear();
+}
+
+/**
+ * Get the execution plan for the currently running command.
+ * Only the toplevel command gets a plan; in its test run to record one, and in its execution run
+ * to replay the one recorded by the test run if that completed it.
+ * @param cmd The command ID of the running command.
+ * @param flags The flags the command is run with.
+ * @return The plan, or nullptr when none can be recorded or replayed.
+ */
+CommandExecPlan *GetCommandExecPlan(uint32 cmd, DoCommandFlag flags)
+{
+	if (_docommand_recursive != 1 || _command_exec_plan_cmd != (cmd & CMD_ID_MASK)) return nullptr;
+	switch (_command_exec_plan_mode) {
+		case CEPM_RECORD: return (flags & DC_EXEC) ? nullptr : &_command_exec_plan;
+		case CEPM_REPLAY: return (flags & DC_EXEC) ? &_command_exec_plan : nullptr;
+		default: return nullptr;
+	}
+}
+
 struct cmd_text_info_dumper {
 	const char *CommandTextInfo(const char *text, uint32 binary_length)
 	{
@@ -751,7 +886,10 @@ CommandCost DoCommandEx(TileIndex tile, uint32 p1, uint32 p2, uint64 p3, DoComma
 
 	/* only execute the test call if it's toplevel, or we're not execing. */
 	if (_docommand_recursive == 1 || !(flags & DC_EXEC) ) {
-		if (_docommand_recursive == 1) _cleared_object_areas.clear();
+		if (_docommand_recursive == 1) {
+			_cleared_object_areas.clear();
+			BeginCommandExecPlan(cmd);
+		}
 		SetTownRatingTestMode(true);
 		res = command.Execute(tile, flags & ~DC_EXEC, p1, p2, p3, text, binary_length);
 		SetTownRatingTestMode(false);
@@ -767,6 +905,7 @@ CommandCost DoCommandEx(TileIndex tile, uint32 p1, uint32 p2, uint64 p3, DoComma
 		}
 
 		if (!(flags & DC_EXEC)) {
+			if (_docommand_recursive == 1) EndCommandExecPlan();
 			_docommand_recursive--;
 			return res;
 		}
@@ -774,15 +913,20 @@ CommandCost DoCommandEx(TileIndex tile, uint32 p1, uint32 p2, uint64 p3, DoComma
 
 	/* Execute the command here. All cost-relevant functions set the expenses type
 	 * themselves to the cost object at some point */
-	if (_docommand_recursive == 1) _cleared_object_areas.clear();
+	if (_docommand_recursive == 1) {
+		_cleared_object_areas.clear();
+		ReplayCommandExecPlan();
+	}
 	res = command.Execute(tile, flags, p1, p2, p3, text, binary_length);
 	if (res.Failed()) {
 error:
+		if (_docommand_recursive == 1) EndCommandExecPlan();
 		_docommand_recursive--;
 		return res;
 	}
 
 	/* if toplevel, subtract the money. */
+	if (_docommand_recursive == 1) EndCommandExecPlan();
 	if (--_docommand_recursive == 0 && !(flags & DC_BANKRUPT)) {
 		SubtractMoneyFromCompany(res);
 	}
@@ -937,7 +1081,7 @@ CommandCost DoCommandPScript(TileIndex tile, uint32 p1, uint32 p2, uint64 p3, ui
  * Helper to deduplicate the code for returning.
  * @param cmd   the command cost to return.
  */
-#define return_dcpi(cmd) { _docommand_recursive = 0; return cmd; }
+#define return_dcpi(cmd) { _docommand_recursive = 0; EndCommandExecPlan(); return cmd; }
 
 /*!
  * Helper function for the toplevel network safe docommand function for the current company.
@@ -979,6 +1123,8 @@ CommandCost DoCommandPInternal(TileIndex tile, uint32 p1, uint32 p2, uint64 p3,
 	/* Make sure p2 is properly set to a ClientID. */
 	assert(!(cmd_flags & CMD_CLIENT_ID) || p2 != 0);
 
+	CommandProfileScope profile(tile, p1, p2, p3, cmd, text, binary_length);
+
 	/* Do not even think about executing out-of-bounds tile-commands */
 	if (tile != 0 && (tile >= MapSize() || (!IsValidTile(tile) && (cmd_flags & CMD_ALL_TILES) == 0))) return_dcpi(CMD_ERROR);
 
@@ -1001,9 +1147,13 @@ CommandCost DoCommandPInternal(TileIndex tile, uint32 p1, uint32 p2, uint64 p3,
 
 	/* Test the command. */
 	_cleared_object_areas.clear();
+	BeginCommandExecPlan(cmd);
 	SetTownRatingTestMode(true);
 	BasePersistentStorageArray::SwitchMode(PSM_ENTER_TESTMODE);
+	CommandProfileScope::clock::time_point test_start = CommandProfileScope::clock::now();
 	CommandCost res = command.Execute(tile, flags, p1, p2, p3, text, binary_length);
+	profile.test_time = CommandProfileScope::clock::now() - test_start;
+	profile.ran = true;
 	BasePersistentStorageArray::SwitchMode(PSM_LEAVE_TESTMODE);
 	SetTownRatingTestMode(false);
 
@@ -1052,10 +1202,14 @@ CommandCost DoCommandPInternal(TileIndex tile, uint32 p1, uint32 p2, uint64 p3,
 			_date, _date_fract, _tick_skip_counter, (int)_current_company, tile, TileX(tile), TileY(tile), p1, p2, p3, cmd & ~CMD_NETWORK_COMMAND, text, binary_length, GetCommandName(cmd));
 
 	/* Actually try and execute the command. If no cost-type is given
-	 * use the construction one */
+	 * use the construction one. The execution can use the plan recorded
+	 * by the test run, unless test and execution can differ. */
 	_cleared_object_areas.clear();
+	ReplayCommandExecPlan();
 	BasePersistentStorageArray::SwitchMode(PSM_ENTER_COMMAND);
+	CommandProfileScope::clock::time_point exec_start = CommandProfileScope::clock::now();
 	CommandCost res2 = command.Execute(tile, flags | DC_EXEC, p1, p2, p3, text, binary_length);
+	profile.exec_time = CommandProfileScope::clock::now() - exec_start;
 	BasePersistentStorageArray::SwitchMode(PSM_LEAVE_COMMAND);
 
 	if (cmd_id == CMD_COMPANY_CTRL) {
@@ -12,6 +12,7 @@
 
 #include "command_type.h"
 #include "company_type.h"
+#include <vector>
 
 /**
  * Define a default return value for a failed command.
@@ -82,6 +83,43 @@ static inline DoCommandFlag CommandFlagsToDCFlags(CommandFlags cmd_flags)
 	return flags;
 }
 
+/**
+ * Execution plan of a toplevel command.
+ * A command may record a plan in its test run, which is then replayed by its execution run
+ * of the same DoCommand/DoCommandP call, so the execution run can skip work whose outcome the
+ * test run already determined. The plan is only handed to the execution run when the test run
+ * marked it complete, and never for commands where test and execution can differ.
+ * A command must produce the same result when no plan is available.
+ */
+struct CommandExecPlan {
+	std::vector<uint32> data; ///< Command specific data of the plan.
+	size_t read_pos = 0;      ///< Position of the next item to read during replay.
+	bool complete = false;    ///< Whether the test run completely recorded the plan.
+
+	/**
+	 * Add an item to the plan during recording.
+	 * @param value The value to add.
+	 */
+	void Add(uint32 value) { this->data.push_back(value); }
+
+	/**
+	 * Read the next item of the plan during replay.
+	 * @param[out] value The read value.
+	 * @return False when the plan is exhausted.
+	 */
+	bool Read(uint32 &value)
+	{
+		if (this->read_pos >= this->data.size()) return false;
+		value = this->data[this->read_pos++];
+		return true;
+	}
+
+	/** Mark the recording of the plan as complete. */
+	void SetComplete() { this->complete = true; }
+};
+
+CommandExecPlan *GetCommandExecPlan(uint32 cmd, DoCommandFlag flags);
+
 void ClearCommandLog();
 char *DumpCommandLog(char *buffer, const char *last);
 
@@ -0,0 +1,64 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file command_profile.h Timing of the execution of commands. */
+
+#ifndef COMMAND_PROFILE_H
+#define COMMAND_PROFILE_H
+
+#include "command_type.h"
+#include "company_type.h"
+#include "date_type.h"
+#include "tile_type.h"
+#include <deque>
+#include <string>
+
+/** Slot of the command profile for commands not run by a playable company. */
+static const uint COMMAND_PROFILE_OTHER_COMPANY = MAX_COMPANIES;
+/** Maximum number of entries in the slow command log. */
+static const uint SLOW_COMMAND_LOG_SIZE = 64;
+
+/** Accumulated timing of a command for a company. All times are in microseconds. */
+struct CommandProfileEntry {
+	uint32 count = 0;     ///< Number of times the command was run
+	uint64 test_time = 0; ///< Total time spent in test runs
+	uint64 exec_time = 0; ///< Total time spent in execution runs
+	uint32 max_time = 0;  ///< Longest time of a single run, test and execution combined
+
+	/**
+	 * Add the timing of another entry to this one.
+	 * @param other The entry to add.
+	 */
+	void Add(const CommandProfileEntry &other)
+	{
+		this->count += other.count;
+		this->test_time += other.test_time;
+		this->exec_time += other.exec_time;
+		this->max_time = std::max(this->max_time, other.max_time);
+	}
+};
+
+/** Command which took longer than the slow command threshold. All times are in microseconds. */
+struct SlowCommandLogEntry {
+	Date date;            ///< Date the command was run at
+	DateFract date_fract; ///< Date fraction the command was run at
+	CompanyID company;    ///< Company running the command
+	uint32 cmd;           ///< The command, including flags
+	TileIndex tile;       ///< Tile parameter of the command
+	uint32 p1;            ///< First parameter of the command
+	uint32 p2;            ///< Second parameter of the command
+	uint64 p3;            ///< Third parameter of the command
+	std::string text;     ///< Text parameter of the command, empty for binary data
+	uint32 test_time;     ///< Time spent in the test run
+	uint32 exec_time;     ///< Time spent in the execution run
+};
+
+const CommandProfileEntry &GetCommandProfileEntry(uint cmd_id, uint company_slot);
+void ResetCommandProfile();
+const std::deque<SlowCommandLogEntry> &GetSlowCommandLog();
+
+#endif /* COMMAND_PROFILE_H */
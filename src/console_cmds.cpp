@@ -33,6 +33,7 @@
 #include "gamelog.h"
 #include "ai/ai.hpp"
 #include "ai/ai_config.hpp"
+#include "ai/ai_instance.hpp"
 #include "newgrf.h"
 #include "newgrf_profiling.h"
 #include "console_func.h"
@@ -40,6 +41,7 @@
 #include "road.h"
 #include "rail.h"
 #include "game/game.hpp"
+#include "game/game_instance.hpp"
 #include "table/strings.h"
 #include "aircraft.h"
 #include "airport.h"
@@ -53,6 +55,8 @@
 #include "linkgraph/linkgraphjob.h"
 #include "base_media_base.h"
 #include "debug_settings.h"
+#include "state_hash.h"
+#include "command_profile.h"
 #include <time.h>
 
 #include "safeguards.h"
@@ -1405,6 +1409,45 @@ DEF_CONSOLE_CMD(ConRescanAI)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConScriptMemoryStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show memory allocator statistics of running scripts. Usage: 'script_memory_stats [<company-id> | game]'");
+		IConsoleHelp("Without an argument, statistics of the game script and all AIs are shown. For company-id's, see the list of companies from the dropdown menu. Company 1 is 1, etc.");
+		return true;
+	}
+
+	auto print = [](const char *line) {
+		IConsolePrintF(CC_DEFAULT, "  %s", line);
+	};
+
+	const bool show_game = (argc < 2 || strcasecmp(argv[1], "game") == 0);
+	const bool show_ai = (argc < 2 || !show_game);
+	CompanyID ai_company = INVALID_COMPANY;
+	if (argc >= 2 && !show_game) {
+		ai_company = (CompanyID)(atoi(argv[1]) - 1);
+		if (!Company::IsValidAiID(ai_company)) {
+			IConsoleWarning("Company is not controlled by an AI.");
+			return true;
+		}
+	}
+
+	if (show_game && Game::GetInstance() != nullptr) {
+		IConsolePrint(CC_INFO, "Game script:");
+		static_cast<const ScriptInstance *>(Game::GetInstance())->DumpAllocatorStats(print);
+	}
+	if (show_ai) {
+		for (const Company *c : Company::Iterate()) {
+			if (!c->is_ai || c->ai_instance == nullptr) continue;
+			if (ai_company != INVALID_COMPANY && c->index != ai_company) continue;
+			IConsolePrintF(CC_INFO, "AI of company %d:", c->index + 1);
+			static_cast<const ScriptInstance *>(c->ai_instance)->DumpAllocatorStats(print);
+		}
+	}
+
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConRescanGame)
 {
 	if (argc == 0) {
@@ -2304,6 +2347,36 @@ DEF_CONSOLE_CMD(ConVehicleStats)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConVehicleTileHashStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Dump vehicle tile hash stats, and time looking up the positions of all vehicles. Usage: 'dump_veh_tile_hash [<iterations>]'");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	extern void DumpVehicleTileHashStats(char *buffer, const char *last, uint iterations);
+	char buffer[4096];
+	DumpVehicleTileHashStats(buffer, lastof(buffer), argc == 2 ? atoi(argv[1]) : 10);
+	PrintLineByLine(buffer);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConSignalSpeedStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Dump train speed adaptation signal speed table stats.");
+		return true;
+	}
+
+	extern void DumpSignalSpeedStats(char *b, const char *last);
+	char buffer[1024];
+	DumpSignalSpeedStats(buffer, lastof(buffer));
+	PrintLineByLine(buffer);
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConMapStats)
 {
 	if (argc == 0) {
@@ -2694,6 +2767,25 @@ DEF_CONSOLE_CMD(ConCheckCaches)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConStateHash)
+{
+	if (argc == 0) {
+		IConsoleHelp("Debug: Show hierarchical hashes of the game state.  Usage: 'state_hash [blocks]'");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	extern uint32 _frame_counter;
+	StateHashTree tree;
+	tree.Compute(_frame_counter);
+	tree.Dump([&](const char *str) {
+		IConsolePrint(CC_DEFAULT, str);
+	}, argc == 2 && strcmp(argv[1], "blocks") == 0);
+
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConShowTownWindow)
 {
 	if (argc != 2) {
@@ -3085,6 +3177,96 @@ DEF_CONSOLE_CMD(ConNewGRFProfile)
 	return false;
 }
 
+DEF_CONSOLE_CMD(ConNewGRFStackProfile)
+{
+	if (argc == 0) {
+		IConsoleHelp("Sample the time spent resolving NewGRF sprite groups and callbacks for all GRFs, for use with flame graph tools. Sub-commands can be abbreviated.");
+		IConsoleHelp("Usage: newgrf_stack_profile [status]");
+		IConsoleHelp("  Show whether profiling is active.");
+		IConsoleHelp("Usage: newgrf_stack_profile start [<interval>]");
+		IConsoleHelp("  Begin profiling. If an interval is provided, only one in that many top-level resolutions is sampled.");
+		IConsoleHelp("Usage: newgrf_stack_profile stop");
+		IConsoleHelp("  End profiling and write the collected data to a folded stack file.");
+		IConsoleHelp("Usage: newgrf_stack_profile abort");
+		IConsoleHelp("  End profiling and discard all collected data.");
+		return true;
+	}
+
+	NewGRFStackProfiler &profiler = _newgrf_stack_profiler;
+
+	/* "status" sub-command */
+	if (argc == 1 || (strncasecmp(argv[1], "sta", 3) == 0 && strncasecmp(argv[1], "star", 4) != 0)) {
+		if (profiler.active) {
+			IConsolePrintF(CC_INFO, "NewGRF stack profiling active, " OTTD_PRINTF64U " samples (1 in %u), %u stacks, %u ticks",
+					profiler.samples, profiler.interval, (uint)profiler.totals.size(), _scaled_tick_counter - profiler.start_tick);
+		} else {
+			IConsolePrint(CC_INFO, "NewGRF stack profiling not active");
+		}
+		return true;
+	}
+
+	/* "start" sub-command */
+	if (strncasecmp(argv[1], "star", 4) == 0) {
+		if (profiler.active) {
+			IConsolePrint(CC_WARNING, "NewGRF stack profiling is already active.");
+			return true;
+		}
+		uint32 interval = 1;
+		if (argc >= 3) {
+			interval = atoi(argv[2]);
+			if (interval == 0) {
+				IConsolePrint(CC_WARNING, "Invalid sampling interval.");
+				return true;
+			}
+		}
+		profiler.Start(interval);
+		IConsolePrintF(CC_INFO, "Started NewGRF stack profiling, sampling 1 in %u resolutions.", profiler.interval);
+		return true;
+	}
+
+	/* "stop" sub-command */
+	if (strncasecmp(argv[1], "sto", 3) == 0) {
+		uint64 total = profiler.Finish();
+		if (total > 0) IConsolePrintF(CC_DEBUG, "Estimated total NewGRF resolution time: " OTTD_PRINTF64U " microseconds", total);
+		return true;
+	}
+
+	/* "abort" sub-command */
+	if (strncasecmp(argv[1], "abo", 3) == 0) {
+		profiler.Abort();
+		return true;
+	}
+
+	return false;
+}
+
+DEF_CONSOLE_CMD(ConNewGRFVarAction2Stats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Dump statistics of the VarAction2 load-time optimiser, per loaded GRF.");
+		return true;
+	}
+
+	extern const std::vector<GRFFile *> &GetAllGRFFiles();
+	const std::vector<GRFFile *> &files = GetAllGRFFiles();
+
+	VarAction2OptimiseStats total{};
+	int i = 1;
+	for (const GRFFile *grf : files) {
+		const VarAction2OptimiseStats &stats = grf->va2_optimise_stats;
+		IConsolePrintF(CC_INFO, "%d: [%08X] %s", i, BSWAP32(grf->grfid), grf->filename);
+		IConsolePrintF(CC_DEFAULT, "  groups: %u, adjusts: %u, removed: %u (folded: %u, no-op: %u, dead: %u, dead stores: %u), jump tables: %u",
+				stats.groups, stats.adjusts, stats.adjusts_removed, stats.constants_folded, stats.noops_removed, stats.dead_adjusts, stats.dead_stores, stats.jump_tables);
+		total.groups += stats.groups;
+		total.adjusts += stats.adjusts;
+		total.adjusts_removed += stats.adjusts_removed;
+		total.jump_tables += stats.jump_tables;
+		i++;
+	}
+	IConsolePrintF(CC_INFO, "Total: groups: %u, adjusts: %u, removed: %u, jump tables: %u", total.groups, total.adjusts, total.adjusts_removed, total.jump_tables);
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConRoadTypeFlagCtl)
 {
 	if (argc != 3) {
@@ -3239,6 +3421,81 @@ DEF_CONSOLE_CMD(ConFramerateWindow)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConCmdProfile)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show the time spent running commands. Usage: 'cmd_profile [companies | slow | reset]'");
+		IConsoleHelp("  no argument: show the commands which took the most time in total");
+		IConsoleHelp("  companies: show the time spent per company");
+		IConsoleHelp("  slow: show the most recent commands which took longer than network.slow_command_threshold");
+		IConsoleHelp("  reset: reset the timings and the slow command log");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	auto print_entry = [](const char *name, const CommandProfileEntry &entry) {
+		IConsolePrintF(CC_DEFAULT, "  %-36s count: %7u, test: %9.2f ms, exec: %9.2f ms, max: %8.2f ms",
+				name, entry.count, entry.test_time / 1000.0, entry.exec_time / 1000.0, entry.max_time / 1000.0);
+	};
+
+	if (argc == 1) {
+		std::vector<std::pair<uint, CommandProfileEntry>> commands;
+		for (uint cmd = 0; cmd < CMD_END; cmd++) {
+			CommandProfileEntry total;
+			for (uint slot = 0; slot <= COMMAND_PROFILE_OTHER_COMPANY; slot++) total.Add(GetCommandProfileEntry(cmd, slot));
+			if (total.count > 0) commands.emplace_back(cmd, total);
+		}
+		std::sort(commands.begin(), commands.end(), [](const auto &a, const auto &b) {
+			return a.second.test_time + a.second.exec_time > b.second.test_time + b.second.exec_time;
+		});
+		IConsolePrintF(CC_DEFAULT, "Commands by total time (%u of %u):", (uint)std::min<size_t>(commands.size(), 32), (uint)commands.size());
+		for (size_t i = 0; i < commands.size() && i < 32; i++) {
+			print_entry(GetCommandName(commands[i].first), commands[i].second);
+		}
+		return true;
+	}
+
+	if (strcmp(argv[1], "companies") == 0) {
+		IConsolePrint(CC_DEFAULT, "Commands by company:");
+		for (uint slot = 0; slot <= COMMAND_PROFILE_OTHER_COMPANY; slot++) {
+			CommandProfileEntry total;
+			for (uint cmd = 0; cmd < CMD_END; cmd++) total.Add(GetCommandProfileEntry(cmd, slot));
+			if (total.count == 0) continue;
+			char name[32];
+			if (slot == COMMAND_PROFILE_OTHER_COMPANY) {
+				strecpy(name, "Other", lastof(name));
+			} else {
+				seprintf(name, lastof(name), "Company %u", slot + 1);
+			}
+			print_entry(name, total);
+		}
+		return true;
+	}
+
+	if (strcmp(argv[1], "slow") == 0) {
+		const std::deque<SlowCommandLogEntry> &log = GetSlowCommandLog();
+		IConsolePrintF(CC_DEFAULT, "Slow commands (%u):", (uint)log.size());
+		for (const SlowCommandLogEntry &entry : log) {
+			YearMonthDay ymd;
+			ConvertDateToYMD(entry.date, &ymd);
+			IConsolePrintF(CC_DEFAULT, "  %4i-%02i-%02i, %2i | company: %3u, tile: %X (%u x %u), p1: 0x%08X, p2: 0x%08X, p3: " OTTD_PRINTFHEX64PAD ", test: %.2f ms, exec: %.2f ms, cmd: %s%s%s",
+					ymd.year, ymd.month + 1, ymd.day, entry.date_fract, (uint)entry.company, entry.tile, TileX(entry.tile), TileY(entry.tile),
+					entry.p1, entry.p2, entry.p3, entry.test_time / 1000.0, entry.exec_time / 1000.0, GetCommandName(entry.cmd),
+					entry.text.empty() ? "" : ", text: ", entry.text.c_str());
+		}
+		return true;
+	}
+
+	if (strcmp(argv[1], "reset") == 0) {
+		ResetCommandProfile();
+		IConsolePrint(CC_DEFAULT, "Command timings reset.");
+		return true;
+	}
+
+	return false;
+}
+
 DEF_CONSOLE_CMD(ConFindNonRealisticBrakingSignal)
 {
 	if (argc == 0) {
@@ -3361,6 +3618,7 @@ void IConsoleStdLibRegister()
 	IConsole::CmdRegister("list_game",               ConListGame);
 	IConsole::CmdRegister("list_game_libs",          ConListGameLibs);
 	IConsole::CmdRegister("rescan_game",             ConRescanGame);
+	IConsole::CmdRegister("script_memory_stats",     ConScriptMemoryStats);
 
 	IConsole::CmdRegister("companies",               ConCompanies);
 	IConsole::AliasRegister("players",               "companies");
@@ -3446,6 +3704,7 @@ void IConsoleStdLibRegister()
 #endif
 	IConsole::CmdRegister("fps",                     ConFramerate);
 	IConsole::CmdRegister("fps_wnd",                 ConFramerateWindow);
+	IConsole::CmdRegister("cmd_profile",             ConCmdProfile);
 
 	IConsole::CmdRegister("find_non_realistic_braking_signal", ConFindNonRealisticBrakingSignal);
 
@@ -3455,6 +3714,8 @@ void IConsoleStdLibRegister()
 	IConsole::CmdRegister("dump_inflation",          ConDumpInflation,    nullptr, true);
 	IConsole::CmdRegister("dump_cpdp_stats",         ConDumpCpdpStats,    nullptr, true);
 	IConsole::CmdRegister("dump_veh_stats",          ConVehicleStats,     nullptr, true);
+	IConsole::CmdRegister("dump_veh_tile_hash",      ConVehicleTileHashStats, nullptr, true);
+	IConsole::CmdRegister("dump_signal_speeds",      ConSignalSpeedStats, nullptr, true);
 	IConsole::CmdRegister("dump_map_stats",          ConMapStats,         nullptr, true);
 	IConsole::CmdRegister("dump_st_flow_stats",      ConStFlowStats,      nullptr, true);
 	IConsole::CmdRegister("dump_game_events",        ConDumpGameEvents,   nullptr, true);
@@ -3467,6 +3728,7 @@ void IConsoleStdLibRegister()
 	IConsole::CmdRegister("dump_cargo_types",        ConDumpCargoTypes,   nullptr, true);
 	IConsole::CmdRegister("dump_tile",               ConDumpTile,         nullptr, true);
 	IConsole::CmdRegister("check_caches",            ConCheckCaches,      nullptr, true);
+	IConsole::CmdRegister("state_hash",              ConStateHash,        nullptr, true);
 	IConsole::CmdRegister("show_town_window",        ConShowTownWindow,   nullptr, true);
 	IConsole::CmdRegister("show_station_window",     ConShowStationWindow, nullptr, true);
 	IConsole::CmdRegister("show_industry_window",    ConShowIndustryWindow, nullptr, true);
@@ -3481,6 +3743,8 @@ void IConsoleStdLibRegister()
 	/* NewGRF development stuff */
 	IConsole::CmdRegister("reload_newgrfs",          ConNewGRFReload,     ConHookNewGRFDeveloperTool);
 	IConsole::CmdRegister("newgrf_profile",          ConNewGRFProfile,    ConHookNewGRFDeveloperTool);
+	IConsole::CmdRegister("newgrf_stack_profile",    ConNewGRFStackProfile);
+	IConsole::CmdRegister("newgrf_va2_stats",        ConNewGRFVarAction2Stats, nullptr, true);
 	IConsole::CmdRegister("dump_info",               ConDumpInfo);
 	IConsole::CmdRegister("do_disaster",             ConDoDisaster,       ConHookNewGRFDeveloperTool, true);
 	IConsole::CmdRegister("bankrupt_company",        ConBankruptCompany,  ConHookNewGRFDeveloperTool, true);
@@ -273,6 +273,40 @@ class Kdtree {
 		return best;
 	}
 
+	/**
+	 * Search a sub-tree for the element nearest to a given point which passes a filter.
+	 * @param best  Best element found so far and its distance, its distance is the search limit.
+	 * @param found Whether any element has been found so far.
+	 */
+	template <typename Filter>
+	void FindNearestFilteredRecursive(CoordT xy[2], size_t node_idx, int level, Filter &filter, node_distance &best, bool &found) const
+	{
+		/* Dimension index of current level */
+		int dim = level % 2;
+		/* Node reference */
+		const node &n = this->nodes[node_idx];
+
+		/* Coordinate of element splitting at this node */
+		CoordT c = this->xyfunc(n.element, dim);
+		/* This node's distance to target */
+		DistT thisdist = ManhattanDistance(n.element, xy[0], xy[1]);
+		/* Elements at the same distance are ordered by less-than comparison, as in FindNearest */
+		if ((thisdist < best.second || (thisdist == best.second && (!found || n.element < best.first))) && filter(n.element)) {
+			best = std::make_pair(n.element, thisdist);
+			found = true;
+		}
+
+		/* Next node to visit */
+		size_t next = (xy[dim] < c) ? n.left : n.right;
+		if (next != INVALID_NODE) this->FindNearestFilteredRecursive(xy, next, level + 1, filter, best, found);
+
+		/* The other side of the split can only hold a better element if the splitting line is within the current best distance. */
+		size_t opposite = (xy[dim] >= c) ? n.left : n.right; // reverse of above
+		if (opposite != INVALID_NODE && best.second >= abs((int)xy[dim] - (int)c)) {
+			this->FindNearestFilteredRecursive(xy, opposite, level + 1, filter, best, found);
+		}
+	}
+
 	template <typename Outputter>
 	void FindContainedRecursive(CoordT p1[2], CoordT p2[2], size_t node_idx, int level, Outputter outputter) const
 	{
@@ -448,6 +482,29 @@ public:
 		return this->FindNearestRecursive(xy, this->root, 0).first;
 	}
 
+	/**
+	 * Find the element closest to given coordinate, in Manhattan distance, which passes a filter.
+	 * For multiple elements with the same distance, the one comparing smaller with
+	 * a less-than comparison is chosen, so the result does not depend on the shape of the tree.
+	 * @param x      First coordinate of the point to search from.
+	 * @param y      Second coordinate of the point to search from.
+	 * @param filter Predicate taking an element, returning whether it may be chosen.
+	 * @param none   Value to return when no element passes the filter within the limit.
+	 * @param limit  Maximum distance of the element, inclusive.
+	 * @return The closest element which passes the filter, or \a none.
+	 */
+	template <typename Filter>
+	T FindNearestFiltered(CoordT x, CoordT y, Filter filter, T none, DistT limit = std::numeric_limits<DistT>::max()) const
+	{
+		if (this->Count() == 0) return none;
+
+		CoordT xy[2] = { x, y };
+		node_distance best = std::make_pair(none, limit);
+		bool found = false;
+		this->FindNearestFilteredRecursive(xy, this->root, 0, filter, best, found);
+		return found ? best.first : none;
+	}
+
 	/**
 	* Find all items contained within the given rectangle.
 	* @note Start coordinates are inclusive, end coordinates are exclusive. x1<x2 && y1<y2 is a precondition.
@@ -531,6 +531,10 @@ char *CrashLog::FillDesyncCrashLog(char *buffer, const char *last, const DesyncE
 	});
 	if (have_cache_log) buffer += seprintf(buffer, last, "\n");
 
+	if (info.state_hash_report != nullptr) {
+		buffer += seprintf(buffer, last, "State hash comparison:\n%s\n", info.state_hash_report->c_str());
+	}
+
 	buffer += seprintf(buffer, last, "*** End of OpenTTD Multiplayer %s Desync Report ***\n", _network_server ? "Server" : "Client");
 	return buffer;
 }
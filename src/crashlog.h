@@ -24,6 +24,7 @@ struct DesyncExtraInfo {
 
 	Flags flags = DEIF_NONE;
 	FILE **log_file = nullptr; ///< save unclosed log file handle here
+	const std::string *state_hash_report = nullptr; ///< comparison of the client and server state hash trees, if available
 };
 DECLARE_ENUM_AS_BIT_SET(DesyncExtraInfo::Flags)
 
@@ -16,6 +16,8 @@
 #include "vehicle_gui.h"
 #include "vehiclelist.h"
 #include "tracerestrict.h"
+#include "depot_kdtree.h"
+#include "water_map.h"
 
 #include "safeguards.h"
 
@@ -23,6 +25,17 @@
 DepotPool _depot_pool("Depot");
 INSTANTIATE_POOL_METHODS(Depot)
 
+DepotKdtree _ship_depot_kdtree(&Kdtree_DepotXYFunc);
+
+void RebuildDepotKdtree()
+{
+	std::vector<DepotID> depotids;
+	for (const Depot *depot : Depot::Iterate()) {
+		if (IsShipDepotTile(depot->xy) && GetDepotIndex(depot->xy) == depot->index) depotids.push_back(depot->index);
+	}
+	_ship_depot_kdtree.Build(depotids.begin(), depotids.end());
+}
+
 /**
  * Clean up a depot
  */
@@ -35,6 +48,8 @@ Depot::~Depot()
 		return;
 	}
 
+	if (IsShipDepotTile(this->xy)) _ship_depot_kdtree.Remove(this->index);
+
 	/* Clear the order backup. */
 	OrderBackup::Reset(this->xy, false);
 
@@ -0,0 +1,28 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file depot_kdtree.h Declarations for accessing the k-d tree of ship depots */
+
+#ifndef DEPOT_KDTREE_H
+#define DEPOT_KDTREE_H
+
+#include "core/kdtree.hpp"
+#include "depot_base.h"
+#include "map_func.h"
+
+inline uint32 Kdtree_DepotXYFunc(DepotID did, int dim) { return (dim == 0) ? TileX(Depot::Get(did)->xy) : TileY(Depot::Get(did)->xy); }
+typedef Kdtree<DepotID, decltype(&Kdtree_DepotXYFunc), uint32, int> DepotKdtree;
+
+/**
+ * Ship depots, by their north tile.
+ * Train and road vehicle depots are not included, these are found by the pathfinders.
+ */
+extern DepotKdtree _ship_depot_kdtree;
+
+void RebuildDepotKdtree();
+
+#endif /* DEPOT_KDTREE_H */
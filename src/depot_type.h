@@ -13,6 +13,8 @@
 typedef uint16 DepotID; ///< Type for the unique identifier of depots.
 struct Depot;
 
+static const DepotID INVALID_DEPOT = UINT16_MAX; ///< An invalid depot
+
 static const uint MAX_LENGTH_DEPOT_NAME_CHARS = 128; ///< The maximum length of a depot name in characters including '\0'
 
 #endif /* DEPOT_TYPE_H */
@@ -23,6 +23,7 @@
 #include "ai/ai_instance.hpp"
 #include "game/game.hpp"
 #include "game/game_instance.hpp"
+#include "settings_type.h"
 
 #include "widgets/framerate_widget.h"
 #include "safeguards.h"
@@ -371,7 +372,10 @@ static const NWidgetPart _framerate_window_widgets[] = {
 					NWidget(WWT_EMPTY, COLOUR_GREY, WID_FRW_TIMES_CURRENT), SetScrollbar(WID_FRW_SCROLLBAR),
 					NWidget(WWT_EMPTY, COLOUR_GREY, WID_FRW_TIMES_AVERAGE), SetScrollbar(WID_FRW_SCROLLBAR),
 					NWidget(NWID_SELECTION, INVALID_COLOUR, WID_FRW_SEL_MEMORY),
-						NWidget(WWT_EMPTY, COLOUR_GREY, WID_FRW_ALLOCSIZE), SetScrollbar(WID_FRW_SCROLLBAR),
+						NWidget(NWID_HORIZONTAL), SetPIP(0, 6, 0),
+							NWidget(WWT_EMPTY, COLOUR_GREY, WID_FRW_ALLOCSIZE), SetScrollbar(WID_FRW_SCROLLBAR),
+							NWidget(WWT_EMPTY, COLOUR_GREY, WID_FRW_OPCODES), SetScrollbar(WID_FRW_SCROLLBAR),
+						EndContainer(),
 					EndContainer(),
 				EndContainer(),
 				NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_DATA_POINTS), SetDataTip(STR_FRAMERATE_DATA_POINTS, 0x0),
@@ -564,7 +568,8 @@ struct FramerateWindow : Window {
 
 			case WID_FRW_TIMES_CURRENT:
 			case WID_FRW_TIMES_AVERAGE:
-			case WID_FRW_ALLOCSIZE: {
+			case WID_FRW_ALLOCSIZE:
+			case WID_FRW_OPCODES: {
 				*size = GetStringBoundingBox(STR_FRAMERATE_CURRENT + (widget - WID_FRW_TIMES_CURRENT));
 				SetDParam(0, 999999);
 				SetDParam(1, 2);
@@ -601,25 +606,33 @@ struct FramerateWindow : Window {
 		}
 	}
 
-	void DrawElementAllocationsColumn(const Rect &r) const
+	/**
+	 * Render a column of values of the script instances, leaving the lines of the other elements empty.
+	 * @param r Rect of the column.
+	 * @param heading_str String of the column heading.
+	 * @param get_value Getter of the value of a script instance.
+	 * @param value_str String to format the value with.
+	 * @param bad_value_str String to format the value with from \a bad_threshold on.
+	 * @param bad_threshold Value from which on \a bad_value_str is used.
+	 */
+	template <typename F>
+	void DrawElementScriptColumn(const Rect &r, StringID heading_str, F get_value, StringID value_str, StringID bad_value_str = STR_NULL, uint64 bad_threshold = UINT64_MAX) const
 	{
 		const Scrollbar *sb = this->GetScrollbar(WID_FRW_SCROLLBAR);
 		uint16 skip = sb->GetPosition();
 		int drawable = this->num_displayed;
 		int y = r.top;
-		DrawString(r.left, r.right, y, STR_FRAMERATE_MEMORYUSE, TC_FROMSTRING, SA_CENTER, true);
+		DrawString(r.left, r.right, y, heading_str, TC_FROMSTRING, SA_CENTER, true);
 		y += FONT_HEIGHT_NORMAL + VSPACING;
 		for (PerformanceElement e : DISPLAY_ORDER_PFE) {
 			if (_pf_data[e].num_valid == 0) continue;
 			if (skip > 0) {
 				skip--;
 			} else if (e == PFE_GAMESCRIPT || e >= PFE_AI0) {
-				if (e == PFE_GAMESCRIPT) {
-					SetDParam(0, Game::GetInstance()->GetAllocatedMemory());
-				} else {
-					SetDParam(0, Company::Get(e - PFE_AI0)->ai_instance->GetAllocatedMemory());
-				}
-				DrawString(r.left, r.right, y, STR_FRAMERATE_BYTES_GOOD, TC_FROMSTRING, SA_RIGHT);
+				const ScriptInstance *instance = (e == PFE_GAMESCRIPT) ? static_cast<const ScriptInstance *>(Game::GetInstance()) : Company::Get(e - PFE_AI0)->ai_instance;
+				const uint64 value = get_value(instance);
+				SetDParam(0, value);
+				DrawString(r.left, r.right, y, value >= bad_threshold ? bad_value_str : value_str, TC_FROMSTRING, SA_RIGHT);
 				y += FONT_HEIGHT_NORMAL;
 				drawable--;
 				if (drawable == 0) break;
@@ -669,7 +682,12 @@ struct FramerateWindow : Window {
 				DrawElementTimesColumn(r, STR_FRAMERATE_AVERAGE, this->times_longterm);
 				break;
 			case WID_FRW_ALLOCSIZE:
-				DrawElementAllocationsColumn(r);
+				DrawElementScriptColumn(r, STR_FRAMERATE_MEMORYUSE, [](const ScriptInstance *instance) -> uint64 { return instance->GetAllocatedMemory(); },
+						STR_FRAMERATE_BYTES_GOOD);
+				break;
+			case WID_FRW_OPCODES:
+				DrawElementScriptColumn(r, STR_FRAMERATE_OPCODES, [](const ScriptInstance *instance) -> uint64 { return instance->GetAverageOpcodesUsed(); },
+						STR_FRAMERATE_OPCODES_GOOD, STR_FRAMERATE_OPCODES_BAD, _settings_game.script.script_max_opcode_till_suspend);
 				break;
 		}
 	}
@@ -1015,6 +1033,25 @@ void ShowFrametimeGraphWindow(PerformanceElement elem)
 	AllocateWindowDescFront<FrametimeGraphWindow>(&_frametime_graph_window_desc, elem, true);
 }
 
+/**
+ * Get a summary of the recent measurements of a performance element, for reporting outside of the GUI.
+ * @param elem The element to summarise.
+ * @param[out] rate The measured rate of the element, in cycles per second.
+ * @param[out] short_term_ms The average duration of the last few cycles, in milliseconds.
+ * @param[out] long_term_ms The average duration of all recorded cycles, in milliseconds.
+ * @return Whether the element has any measurements.
+ */
+bool GetPerformanceElementSummary(PerformanceElement elem, double &rate, double &short_term_ms, double &long_term_ms)
+{
+	auto &pf = _pf_data[elem];
+	if (pf.num_valid == 0) return false;
+
+	rate = pf.GetRate();
+	short_term_ms = pf.GetAverageDurationMilliseconds(8);
+	long_term_ms = pf.GetAverageDurationMilliseconds(NUM_FRAMERATE_POINTS);
+	return true;
+}
+
 /** Print performance statistics to game console */
 void ConPrintFramerate()
 {
@@ -1072,6 +1109,16 @@ void ConPrintFramerate()
 			pf.GetAverageDurationMilliseconds(count2),
 			pf.GetAverageDurationMilliseconds(count3));
 		printed_anything = true;
+
+		const ScriptInstance *instance = nullptr;
+		if (e == PFE_GAMESCRIPT) {
+			instance = Game::GetInstance();
+		} else if (e >= PFE_AI0 && Company::IsValidAiID(e - PFE_AI0)) {
+			instance = Company::Get(e - PFE_AI0)->ai_instance;
+		}
+		if (instance != nullptr) {
+			IConsolePrintF(TC_LIGHT_BLUE, "%s opcodes: %u (average), %u (last run)", name, instance->GetAverageOpcodesUsed(), instance->GetLastOpcodesUsed());
+		}
 	}
 
 	if (!printed_anything) {
@@ -121,5 +121,6 @@ public:
 };
 
 void ShowFramerateWindow();
+bool GetPerformanceElementSummary(PerformanceElement elem, double &rate, double &short_term_ms, double &long_term_ms);
 
 #endif /* FRAMERATE_TYPE_H */
@@ -29,6 +29,11 @@ public:
 	 */
 	static void GameLoop();
 
+	/**
+	 * Claim the share of the per-tick opcode budget of the Game, if it runs in this tick.
+	 */
+	static void ScheduleOpcodeBudget();
+
 	/**
 	 * Initialize the Game system.
 	 */
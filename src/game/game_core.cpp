@@ -54,6 +54,12 @@
 	}
 }
 
+/* static */ void Game::ScheduleOpcodeBudget()
+{
+	if (_networking && !_network_server) return;
+	if (Game::instance != nullptr) Game::instance->ScheduleOpcodeBudget();
+}
+
 /* static */ void Game::Initialize()
 {
 	if (Game::instance != nullptr) Game::Uninitialize(true);
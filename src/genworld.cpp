@@ -173,6 +173,8 @@ static void _GenerateWorld()
 					SetGeneratingWorldProgress(GWP_RUNSCRIPT, 2500);
 					_generating_world = true;
 					for (i = 0; i < 2500; i++) {
+						ScriptInstance::BeginOpcodeBudget();
+						Game::ScheduleOpcodeBudget();
 						Game::GameLoop();
 						IncreaseGeneratingWorldProgress(GWP_RUNSCRIPT);
 						if (Game::GetInstance()->IsSleeping()) break;
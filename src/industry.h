@@ -203,6 +203,8 @@ protected:
 
 void ClearAllIndustryCachedNames();
 
+void RebuildIndustryKdtree();
+
 void PlantRandomFarmField(const Industry *i);
 
 void ReleaseDisastersTargetingIndustry(IndustryID);
@@ -43,6 +43,7 @@
 #include "error.h"
 #include "cmd_helper.h"
 #include "string_func.h"
+#include "industry_kdtree.h"
 
 #include "table/strings.h"
 #include "table/industry_land.h"
@@ -53,6 +54,17 @@
 IndustryPool _industry_pool("Industry");
 INSTANTIATE_POOL_METHODS(Industry)
 
+IndustryKdtree _industry_kdtree(&Kdtree_IndustryXYFunc);
+
+void RebuildIndustryKdtree()
+{
+	std::vector<IndustryID> industryids;
+	for (const Industry *industry : Industry::Iterate()) {
+		industryids.push_back(industry->index);
+	}
+	_industry_kdtree.Build(industryids.begin(), industryids.end());
+}
+
 void ShowIndustryViewWindow(int industry);
 void BuildOilRig(TileIndex tile);
 
@@ -148,6 +160,8 @@ Industry::~Industry()
 	 * Also we must not decrement industry counts in that case. */
 	if (this->location.w == 0) return;
 
+	_industry_kdtree.Remove(this->index);
+
 	const bool has_neutral_station = this->neutral_station != nullptr;
 
 	TILE_AREA_LOOP(tile_cur, this->location) {
@@ -199,6 +213,7 @@ Industry::~Industry()
 
 	for (Station *st : this->stations_near) {
 		st->industries_near.erase(this);
+		st->industries_catchment.erase(this);
 	}
 
 	if (_game_mode == GM_NORMAL) RegisterGameEvents(GEF_INDUSTRY_DELETE);
@@ -1706,38 +1721,17 @@ static CommandCost CheckIfFarEnoughFromConflictingIndustry(TileIndex tile, int t
 {
 	const IndustrySpec *indspec = GetIndustrySpec(type);
 
-	/* On a large map with many industries, it may be faster to check an area. */
-	static const int dmax = 14;
-	if (Industry::GetNumItems() > (size_t) (dmax * dmax * 2)) {
-		const Industry* i = nullptr;
-		TileArea tile_area = TileArea(tile, 1, 1).Expand(dmax);
-		TILE_AREA_LOOP(atile, tile_area) {
-			if (GetTileType(atile) == MP_INDUSTRY) {
-				const Industry *i2 = Industry::GetByTile(atile);
-				if (i == i2) continue;
-				i = i2;
-				if (DistanceMax(tile, i->location.tile) > (uint)dmax) continue;
-				if (i->type == indspec->conflicting[0] ||
-						i->type == indspec->conflicting[1] ||
-						i->type == indspec->conflicting[2]) {
-					return_cmd_error(STR_ERROR_INDUSTRY_TOO_CLOSE);
-				}
-			}
-		}
-		return CommandCost();
-	}
-
-	for (const Industry *i : Industry::Iterate()) {
-		/* Within 14 tiles from another industry is considered close */
-		if (DistanceMax(tile, i->location.tile) > 14) continue;
-
+	/* Within 14 tiles from another industry is considered close */
+	bool too_close = false;
+	ForAllIndustriesRadius(tile, 14, [&](const Industry *i) {
 		/* check if there are any conflicting industry types around */
 		if (i->type == indspec->conflicting[0] ||
 				i->type == indspec->conflicting[1] ||
 				i->type == indspec->conflicting[2]) {
-			return_cmd_error(STR_ERROR_INDUSTRY_TOO_CLOSE);
+			too_close = true;
 		}
-	}
+	});
+	if (too_close) return_cmd_error(STR_ERROR_INDUSTRY_TOO_CLOSE);
 	return CommandCost();
 }
 
@@ -1770,6 +1764,7 @@ static void PopulateStationsNearby(Industry *ind)
 	if (ind->neutral_station != nullptr && !_settings_game.station.serve_neutral_industries) {
 		/* Industry has a neutral station. Use it and ignore any other nearby stations. */
 		ind->stations_near.insert(ind->neutral_station);
+		ind->neutral_station->industries_catchment.insert(ind);
 		ind->neutral_station->industries_near.clear();
 		ind->neutral_station->industries_near.insert(ind);
 		return;
@@ -1778,6 +1773,7 @@ static void PopulateStationsNearby(Industry *ind)
 	ForAllStationsAroundTiles(ind->location, [ind](Station *st, TileIndex tile) {
 		if (!IsTileType(tile, MP_INDUSTRY) || GetIndustryIndex(tile) != ind->index) return false;
 		ind->stations_near.insert(st);
+		st->industries_catchment.insert(ind);
 		st->AddIndustryToDeliver(ind);
 		return true;
 	});
@@ -1976,6 +1972,9 @@ static void DoCreateNewIndustry(Industry *i, TileIndex tile, IndustryType type,
 	}
 	InvalidateWindowData(WC_INDUSTRY_DIRECTORY, 0, IDIWD_FORCE_REBUILD);
 
+	/* The north tile of the industry is final once all tiles have been placed. */
+	_industry_kdtree.Insert(i->index);
+
 	if (!_generating_world) PopulateStationsNearby(i);
 	if (_game_mode == GM_NORMAL) RegisterGameEvents(GEF_INDUSTRY_CREATE);
 }
@@ -0,0 +1,64 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file industry_kdtree.h Declarations for accessing the k-d tree of industries */
+
+#ifndef INDUSTRY_KDTREE_H
+#define INDUSTRY_KDTREE_H
+
+#include "core/kdtree.hpp"
+#include "core/math_func.hpp"
+#include "industry.h"
+#include "map_func.h"
+
+inline uint32 Kdtree_IndustryXYFunc(IndustryID iid, int dim) { return (dim == 0) ? TileX(Industry::Get(iid)->location.tile) : TileY(Industry::Get(iid)->location.tile); }
+typedef Kdtree<IndustryID, decltype(&Kdtree_IndustryXYFunc), uint32, int> IndustryKdtree;
+extern IndustryKdtree _industry_kdtree;
+
+/**
+ * Call a function on all industries whose north tile is within a radius of a center tile.
+ * @param center  Central tile to search around.
+ * @param radius  Distance in both X and Y to search within.
+ * @param func    The function to call, must take a single parameter which is Industry*.
+ */
+template <typename Func>
+void ForAllIndustriesRadius(TileIndex center, uint radius, Func func)
+{
+	uint32 x1, y1, x2, y2;
+	x1 = (uint32)std::max<int>(0, TileX(center) - radius);
+	x2 = (uint32)std::min<int>(TileX(center) + radius + 1, MapSizeX());
+	y1 = (uint32)std::max<int>(0, TileY(center) - radius);
+	y2 = (uint32)std::min<int>(TileY(center) + radius + 1, MapSizeY());
+
+	_industry_kdtree.FindContained(x1, y1, x2, y2, [&](IndustryID id) {
+		func(Industry::Get(id));
+	});
+}
+
+/**
+ * Find the smallest Manhattan distance from a tile to the north tile of an industry matching a filter.
+ * The search area is doubled until it contains a match, so nearby industries are found without visiting the others.
+ * As the result is only a distance, it does not depend on the order in which the industries are visited.
+ * @param tile   Tile to measure the distance from.
+ * @param filter Predicate taking a const Industry*, returning whether the industry is to be considered.
+ * @return The distance to the closest matching industry, UINT32_MAX if there is none.
+ */
+template <typename Filter>
+uint32 FindClosestIndustryDistance(TileIndex tile, Filter filter)
+{
+	uint32 best_dist = UINT32_MAX;
+	const uint max_radius = std::max(MapSizeX(), MapSizeY());
+	for (uint radius = 16;; radius *= 2) {
+		ForAllIndustriesRadius(tile, radius, [&](const Industry *i) {
+			if (filter(i)) best_dist = std::min(best_dist, DistanceManhattan(tile, i->location.tile));
+		});
+		/* Any industry outside the searched square is further away than the radius. */
+		if (best_dist <= radius || radius >= max_radius) return best_dist;
+	}
+}
+
+#endif /* INDUSTRY_KDTREE_H */
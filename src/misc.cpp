@@ -27,6 +27,8 @@
 #include "game/game.hpp"
 #include "linkgraph/linkgraphschedule.h"
 #include "station_kdtree.h"
+#include "industry_kdtree.h"
+#include "depot_kdtree.h"
 #include "town_kdtree.h"
 #include "viewport_kdtree.h"
 #include "newgrf_profiling.h"
@@ -100,6 +102,7 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	if (reset_settings) MakeNewgameSettingsLive();
 
 	_newgrf_profilers.clear();
+	_newgrf_stack_profiler.Abort();
 
 	if (reset_date) {
 		SetDate(ConvertYMDToDate(_settings_game.game_creation.starting_year, 0, 1), 0);
@@ -116,6 +119,8 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 
 	RebuildStationKdtree();
 	RebuildTownKdtree();
+	RebuildIndustryKdtree();
+	RebuildDepotKdtree();
 	RebuildViewportKdtree();
 
 	FreeSignalPrograms();
@@ -379,6 +379,55 @@ SOCKET NetworkAddress::Connect()
 	return this->Resolve(AF_UNSPEC, SOCK_STREAM, AI_ADDRCONFIG, nullptr, ConnectLoopProc);
 }
 
+/**
+ * Resolve this address into all the addresses it refers to, without creating any socket.
+ * This address itself is resolved to the first of them, like #GetAddress would.
+ * This may block for a long time, so it should not be called from the game thread.
+ * @param socktype the type of socket (TCP, UDP, etc)
+ * @return the resolved addresses, or an empty list when resolving failed.
+ */
+NetworkAddressList NetworkAddress::ResolveAll(int socktype)
+{
+	NetworkAddressList result;
+	if (this->IsResolved()) {
+		result.push_back(*this);
+		return result;
+	}
+
+	struct addrinfo *ai;
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof (hints));
+	hints.ai_family   = this->address.ss_family;
+	hints.ai_flags    = AI_ADDRCONFIG;
+	hints.ai_socktype = socktype;
+
+	/* The port needs to be a string. Six is enough to contain all characters + '\0'. */
+	char port_name[6];
+	seprintf(port_name, lastof(port_name), "%u", this->GetPort());
+
+	int e = getaddrinfo(StrEmpty(this->hostname) ? nullptr : this->hostname, port_name, &hints, &ai);
+	this->resolved = true;
+	if (e != 0) {
+		DEBUG(net, 0, "getaddrinfo for hostname \"%s\", port %s, address family %s and socket type %s failed: %s",
+			this->hostname, port_name, AddressFamilyAsString(this->address.ss_family), SocketTypeAsString(socktype), FS2OTTD(gai_strerror(e)).c_str());
+		return result;
+	}
+
+	for (struct addrinfo *runp = ai; runp != nullptr; runp = runp->ai_next) {
+		NetworkAddress address(runp->ai_addr, (int)runp->ai_addrlen);
+		if (std::any_of(result.begin(), result.end(), [&](NetworkAddress &other) { return other == address; })) continue;
+		result.push_back(address);
+	}
+	freeaddrinfo(ai);
+
+	if (!result.empty()) {
+		this->address_length = result[0].address_length;
+		this->address = result[0].address;
+	}
+
+	return result;
+}
+
 /**
  * Helper function to resolve a listening.
  * @param runp information about the socket to try not
@@ -175,6 +175,7 @@ public:
 	}
 
 	SOCKET Connect();
+	NetworkAddressList ResolveAll(int socktype);
 	void Listen(int socktype, SocketList *sockets);
 
 	static const char *SocketTypeAsString(int socktype);
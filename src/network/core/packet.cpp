@@ -16,8 +16,71 @@
 
 #include "packet.h"
 
+#include <mutex>
+#if defined(__MINGW32__)
+#include "../../3rdparty/mingw-std-threads/mingw.mutex.h"
+#endif
+
 #include "../../safeguards.h"
 
+/**
+ * Buffers of destroyed packets, for reuse by new packets.
+ * Buffers which held at most COMPAT_MTU bytes are kept separately from larger
+ * ones, so that small packets waiting in a send queue do not pin large buffers.
+ */
+struct PacketBufferPool {
+	static const size_t MAX_SMALL_BUFFERS = 256; ///< Maximum number of small buffers to keep
+	static const size_t MAX_LARGE_BUFFERS = 16;  ///< Maximum number of large buffers to keep
+	static const size_t MAX_LARGE_CAPACITY = SHRT_MAX + 1; ///< Larger buffers than this are freed
+
+	std::mutex lock;
+	std::vector<std::vector<byte>> small_buffers;
+	std::vector<std::vector<byte>> large_buffers;
+
+	/**
+	 * Take a buffer from the pool, if there is one.
+	 * @param buffer Empty buffer to replace.
+	 * @param size Number of bytes the buffer is expected to hold.
+	 */
+	void Acquire(std::vector<byte> &buffer, size_t size)
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		std::vector<std::vector<byte>> &buffers = (size > COMPAT_MTU) ? this->large_buffers : this->small_buffers;
+		if (buffers.empty()) return;
+		buffer.swap(buffers.back());
+		buffers.pop_back();
+	}
+
+	/**
+	 * Return a buffer to the pool, or free it when the pool is full.
+	 * @param buffer Buffer to return, it is left empty.
+	 */
+	void Release(std::vector<byte> &buffer)
+	{
+		const size_t capacity = buffer.capacity();
+		if (capacity == 0 || capacity > MAX_LARGE_CAPACITY) return;
+
+		std::lock_guard<std::mutex> guard(this->lock);
+		const bool large = (capacity > COMPAT_MTU);
+		std::vector<std::vector<byte>> &buffers = large ? this->large_buffers : this->small_buffers;
+		if (buffers.size() >= (large ? MAX_LARGE_BUFFERS : MAX_SMALL_BUFFERS)) return;
+		buffer.clear();
+		buffers.emplace_back();
+		buffers.back().swap(buffer);
+	}
+};
+
+/**
+ * Get the packet buffer pool.
+ * The pool is never freed, so packets can still be destroyed while static objects are being destructed.
+ * @return The pool.
+ */
+static PacketBufferPool &GetPacketBufferPool()
+{
+	static PacketBufferPool *pool = new PacketBufferPool();
+	return *pool;
+}
+
 /**
  * Create a packet that is used to read from a network socket.
  * @param cs                The socket handler associated with the socket we are reading from.
@@ -35,6 +98,7 @@ Packet::Packet(NetworkSocketHandler *cs, size_t limit, size_t initial_read_size)
 	assert(cs != nullptr);
 
 	this->cs = cs;
+	GetPacketBufferPool().Acquire(this->buffer, initial_read_size);
 	this->buffer.resize(initial_read_size);
 }
 
@@ -48,9 +112,51 @@ Packet::Packet(NetworkSocketHandler *cs, size_t limit, size_t initial_read_size)
  */
 Packet::Packet(PacketType type, size_t limit) : pos(0), limit(limit), cs(nullptr)
 {
+	GetPacketBufferPool().Acquire(this->buffer, 0);
 	this->ResetState(type);
 }
 
+/**
+ * Creates a packet to send from data which has already been prepared, and
+ * which may be shared with packets queued on other sockets.
+ * The data may hold several complete packets, but is limited to SHRT_MAX bytes.
+ * @param data The prepared data.
+ */
+Packet::Packet(SharedPacketData data) : pos(0), limit(data->size()), cs(nullptr), shared_data(std::move(data))
+{
+	assert(this->shared_data->size() >= sizeof(PacketSize) + sizeof(PacketType));
+	assert(this->shared_data->size() <= SHRT_MAX);
+}
+
+/**
+ * Destroy the packet, keeping its buffer for reuse by a later packet.
+ */
+Packet::~Packet()
+{
+	GetPacketBufferPool().Release(this->buffer);
+}
+
+/**
+ * Reserve space in the buffer for at least the given total number of bytes.
+ * A previously used buffer of sufficient size is reused when available.
+ * @param size The number of bytes to reserve.
+ */
+void Packet::ReserveBuffer(size_t size)
+{
+	if (size <= this->buffer.capacity()) return;
+
+	std::vector<byte> reused;
+	GetPacketBufferPool().Acquire(reused, size);
+	if (reused.capacity() >= size) {
+		reused.assign(this->buffer.begin(), this->buffer.end());
+		reused.swap(this->buffer);
+		GetPacketBufferPool().Release(reused);
+	} else {
+		GetPacketBufferPool().Release(reused);
+		this->buffer.reserve(size);
+	}
+}
+
 void Packet::ResetState(PacketType type)
 {
 	this->cs = nullptr;
@@ -68,11 +174,16 @@ void Packet::PrepareToSend()
 {
 	assert(this->cs == nullptr);
 
+	if (this->shared_data != nullptr) {
+		/* The shared data is already prepared. */
+		this->pos = 0;
+		return;
+	}
+
 	this->buffer[0] = GB(this->Size(), 0, 8);
 	this->buffer[1] = GB(this->Size(), 8, 8);
 
 	this->pos  = 0; // We start reading from here
-	this->buffer.shrink_to_fit();
 }
 
 /**
@@ -251,7 +362,7 @@ bool Packet::HasPacketSizeData() const
  */
 size_t Packet::Size() const
 {
-	return this->buffer.size();
+	return this->shared_data != nullptr ? this->shared_data->size() : this->buffer.size();
 }
 
 size_t Packet::ReadRawPacketSize() const
@@ -295,7 +406,7 @@ void Packet::PrepareToRead()
 PacketType Packet::GetPacketType() const
 {
 	assert(this->Size() >= sizeof(PacketSize) + sizeof(PacketType));
-	return static_cast<PacketType>(buffer[sizeof(PacketSize)]);
+	return static_cast<PacketType>(this->GetBufferData()[sizeof(PacketSize)]);
 }
 
 /**
@@ -413,6 +524,17 @@ size_t Packet::RemainingBytesToTransfer() const
 	return this->Size() - this->pos;
 }
 
+/**
+ * Mark a number of bytes as transferred, after they were written out by the caller
+ * using the data returned by GetRemainingTransferData.
+ * @param bytes The number of bytes which were transferred.
+ */
+void Packet::AdvanceTransfer(size_t bytes)
+{
+	assert(bytes <= this->RemainingBytesToTransfer());
+	this->pos += (PacketSize)bytes;
+}
+
 /**
  * Reads a string till it finds a '\0' in the stream.
  * @param buffer The buffer to put the data into.
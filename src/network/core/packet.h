@@ -19,10 +19,15 @@
 #include <string>
 #include <functional>
 #include <limits>
+#include <memory>
+#include <vector>
 
 typedef uint16 PacketSize; ///< Size of the whole packet.
 typedef uint8  PacketType; ///< Identifier for the packet
 
+/** Immutable data of one or more packets which are ready to send, so it can be queued on several sockets at once. */
+typedef std::shared_ptr<const std::vector<byte>> SharedPacketData;
+
 /**
  * Internal entity of a packet. As everything is sent as a packet,
  * all network communication will need to call the functions that
@@ -54,9 +59,14 @@ private:
 	/** Socket we're associated with. */
 	NetworkSocketHandler *cs;
 
+	/** Prepared data shared with other packets, used instead of buffer when set. */
+	SharedPacketData shared_data;
+
 public:
 	Packet(NetworkSocketHandler *cs, size_t limit, size_t initial_read_size = sizeof(PacketSize));
 	Packet(PacketType type, size_t limit = COMPAT_MTU);
+	Packet(SharedPacketData data);
+	~Packet();
 
 	void ResetState(PacketType type);
 
@@ -93,10 +103,12 @@ public:
 	void   Recv_binary(std::string &buffer, size_t size);
 
 	size_t RemainingBytesToTransfer() const;
+	void AdvanceTransfer(size_t bytes);
 
-	const byte *GetBufferData() const { return this->buffer.data(); }
+	const byte *GetBufferData() const { return this->shared_data != nullptr ? this->shared_data->data() : this->buffer.data(); }
+	const byte *GetRemainingTransferData() const { return this->GetBufferData() + this->pos; }
 	PacketSize GetRawPos() const { return this->pos; }
-	void ReserveBuffer(size_t size) { this->buffer.reserve(size); }
+	void ReserveBuffer(size_t size);
 
 	/**
 	 * Transfer data from the packet to the given function. It starts reading at the
@@ -120,10 +132,10 @@ public:
 		size_t amount = std::min(this->RemainingBytesToTransfer(), limit);
 		if (amount == 0) return 0;
 
-		assert(this->pos < this->buffer.size());
-		assert(this->pos + amount <= this->buffer.size());
+		assert(this->pos < this->Size());
+		assert(this->pos + amount <= this->Size());
 		/* Making buffer a char means casting a lot in the Recv/Send functions. */
-		const char *output_buffer = reinterpret_cast<const char*>(this->buffer.data() + this->pos);
+		const char *output_buffer = reinterpret_cast<const char*>(this->GetRemainingTransferData());
 		ssize_t bytes = transfer_function(destination, output_buffer, static_cast<A>(amount), std::forward<Args>(args)...);
 		if (bytes > 0) this->pos += bytes;
 		return bytes;
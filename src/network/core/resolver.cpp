@@ -0,0 +1,82 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file resolver.cpp Resolving of hostnames in the background.
+ * All requests share a queue which is worked on by at most #MAX_RESOLVER_THREADS threads,
+ * which only exist while there is something to resolve.
+ */
+
+#include "../../stdafx.h"
+#include "../../thread.h"
+
+#include "resolver.h"
+
+#include <deque>
+#include <mutex>
+#if defined(__MINGW32__)
+#include "../../3rdparty/mingw-std-threads/mingw.mutex.h"
+#endif
+
+#include "../../safeguards.h"
+
+static std::mutex _resolve_mutex;                                        ///< Mutex guarding the queue and the thread count.
+static std::deque<std::shared_ptr<NetworkResolveRequest>> _resolve_queue; ///< Requests waiting to be resolved.
+static uint _resolve_threads = 0;                                        ///< Number of running resolver threads.
+
+/**
+ * Resolve requests from the queue until it is empty.
+ * @param thread Whether this is run by a resolver thread, which has to be accounted for when the queue is empty.
+ */
+static void NetworkResolveQueue(bool thread)
+{
+	for (;;) {
+		std::shared_ptr<NetworkResolveRequest> request;
+		{
+			std::lock_guard<std::mutex> lock(_resolve_mutex);
+			if (_resolve_queue.empty()) {
+				if (thread) _resolve_threads--;
+				return;
+			}
+			request = std::move(_resolve_queue.front());
+			_resolve_queue.pop_front();
+		}
+
+		request->results = request->address.ResolveAll(request->socktype);
+		request->done = true;
+	}
+}
+
+/**
+ * Queue an address to be resolved in the background.
+ * @param request The request; its \c done flag is set once resolving has finished.
+ */
+void NetworkResolveAsync(std::shared_ptr<NetworkResolveRequest> request)
+{
+	if (request->address.IsResolved()) {
+		request->results.push_back(request->address);
+		request->done = true;
+		return;
+	}
+
+	bool start_thread;
+	{
+		std::lock_guard<std::mutex> lock(_resolve_mutex);
+		_resolve_queue.push_back(std::move(request));
+		start_thread = _resolve_threads < MAX_RESOLVER_THREADS;
+		if (start_thread) _resolve_threads++;
+	}
+
+	if (start_thread && !StartNewThread(nullptr, "ottd:resolver", &NetworkResolveQueue, true)) {
+		{
+			std::lock_guard<std::mutex> lock(_resolve_mutex);
+			_resolve_threads--;
+		}
+		/* No threads, so resolve it right away. */
+		NetworkResolveQueue(false);
+	}
+}
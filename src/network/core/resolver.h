@@ -0,0 +1,37 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file resolver.h Resolving of hostnames in the background.
+ */
+
+#ifndef NETWORK_CORE_RESOLVER_H
+#define NETWORK_CORE_RESOLVER_H
+
+#include "address.h"
+#include <atomic>
+#include <memory>
+
+/** Maximum number of threads resolving hostnames at the same time. */
+static const uint MAX_RESOLVER_THREADS = 2;
+
+/**
+ * Request to resolve an address in the background.
+ * Once #done is set, #address and #results are no longer touched by the resolver and may be used by the requester.
+ */
+struct NetworkResolveRequest {
+	NetworkAddress address;           ///< The address to resolve; resolved to the first result once done
+	int socktype;                     ///< The type of socket (TCP, UDP, etc) to resolve for
+	NetworkAddressList results;       ///< The resolved addresses, empty when resolving failed
+	std::atomic<bool> done;           ///< Whether resolving has finished
+
+	NetworkResolveRequest(const NetworkAddress &address, int socktype) : address(address), socktype(socktype), done(false) {}
+};
+
+void NetworkResolveAsync(std::shared_ptr<NetworkResolveRequest> request);
+
+#endif /* NETWORK_CORE_RESOLVER_H */
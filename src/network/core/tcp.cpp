@@ -14,8 +14,17 @@
 
 #include "tcp.h"
 
+#if defined(UNIX) && !defined(__OS2__) && !defined(__EMSCRIPTEN__)
+#	include <sys/uio.h>
+#	include <limits.h>
+#	define HAVE_SENDMSG
+#endif
+
 #include "../../safeguards.h"
 
+/** Maximum number of queued packets to write to the socket in a single call. */
+static const uint MAX_PACKETS_PER_SEND = 64;
+
 /**
  * Construct a socket handler for a TCP connection.
  * @param s The just opened TCP connection.
@@ -92,6 +101,56 @@ void NetworkTCPSocketHandler::SendPrependPacket(std::unique_ptr<Packet> packet,
 	this->packet_queue.push_front(std::move(packet));
 }
 
+/**
+ * Write the front of the packet queue to the socket in a single call, gathering
+ * the remaining data of multiple packets where the platform supports it.
+ * The packets are not advanced, that is up to the caller.
+ * @param[out] requested The number of bytes that were offered to the socket.
+ * @return The number of bytes written, or -1 upon errors.
+ */
+ssize_t NetworkTCPSocketHandler::SendQueueFront(size_t &requested)
+{
+	requested = 0;
+#if defined(_WIN32)
+	WSABUF buffers[MAX_PACKETS_PER_SEND];
+	DWORD count = 0;
+	for (const auto &p : this->packet_queue) {
+		if (count == MAX_PACKETS_PER_SEND) break;
+		buffers[count].buf = (char *)p->GetRemainingTransferData();
+		buffers[count].len = (ULONG)p->RemainingBytesToTransfer();
+		requested += buffers[count].len;
+		count++;
+	}
+	DWORD sent = 0;
+	if (WSASend(this->sock, buffers, count, &sent, 0, nullptr, nullptr) != 0) return -1;
+	return sent;
+#elif defined(HAVE_SENDMSG)
+#	if defined(IOV_MAX)
+	const uint max_count = std::min<uint>(MAX_PACKETS_PER_SEND, IOV_MAX);
+#	else
+	const uint max_count = std::min<uint>(MAX_PACKETS_PER_SEND, 16);
+#	endif
+	struct iovec buffers[MAX_PACKETS_PER_SEND];
+	uint count = 0;
+	for (const auto &p : this->packet_queue) {
+		if (count == max_count) break;
+		buffers[count].iov_base = const_cast<byte *>(p->GetRemainingTransferData());
+		buffers[count].iov_len = p->RemainingBytesToTransfer();
+		requested += buffers[count].iov_len;
+		count++;
+	}
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = buffers;
+	msg.msg_iovlen = count;
+	return sendmsg(this->sock, &msg, 0);
+#else
+	const Packet *p = this->packet_queue.front().get();
+	requested = p->RemainingBytesToTransfer();
+	return send(this->sock, (const char *)p->GetRemainingTransferData(), (int)requested, 0);
+#endif
+}
+
 /**
  * Sends all the buffered packets out for this client. It stops when:
  *   1) all packets are send (queue is empty)
@@ -111,8 +170,8 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 	if (!this->IsConnected()) return SPS_CLOSED;
 
 	while (!this->packet_queue.empty()) {
-		Packet *p = this->packet_queue.front().get();
-		res = p->TransferOut<int>(send, this->sock, 0);
+		size_t requested;
+		res = this->SendQueueFront(requested);
 		if (res == -1) {
 			int err = NetworkGetLastError();
 			if (err != EWOULDBLOCK) {
@@ -131,14 +190,21 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 			return SPS_CLOSED;
 		}
 
-		/* Is this packet sent? */
-		if (p->RemainingBytesToTransfer() == 0) {
-			/* Go to the next packet */
-			if (_debug_net_level >= 5) this->LogSentPacket(*p);
-			this->packet_queue.pop_front();
-		} else {
-			return SPS_PARTLY_SENT;
+		/* Advance over the sent data, and drop the packets which are completely sent. */
+		size_t remaining = res;
+		while (remaining > 0) {
+			Packet *p = this->packet_queue.front().get();
+			size_t amount = std::min(remaining, p->RemainingBytesToTransfer());
+			p->AdvanceTransfer(amount);
+			remaining -= amount;
+			if (p->RemainingBytesToTransfer() == 0) {
+				if (_debug_net_level >= 5) this->LogSentPacket(*p);
+				this->packet_queue.pop_front();
+			}
 		}
+
+		/* Did the socket accept less than we offered? */
+		if ((size_t)res < requested) return SPS_PARTLY_SENT;
 	}
 
 	return SPS_ALL_SENT;
@@ -18,6 +18,7 @@
 #include <deque>
 #include <memory>
 #include <atomic>
+#include <chrono>
 
 /** The states of sending the packets. */
 enum SendPacketsState {
@@ -32,6 +33,8 @@ class NetworkTCPSocketHandler : public NetworkSocketHandler {
 private:
 	std::deque<std::unique_ptr<Packet>> packet_queue; ///< Packets that are awaiting delivery
 	std::unique_ptr<Packet> packet_recv;              ///< Partially received packet
+
+	ssize_t SendQueueFront(size_t &requested);
 public:
 	SOCKET sock;              ///< The socket currently connected to
 	bool writable;            ///< Can we write to this socket?
@@ -68,19 +71,33 @@ public:
 	~NetworkTCPSocketHandler();
 };
 
+struct NetworkResolveRequest;
+
 /**
- * "Helper" class for creating TCP connections in a non-blocking manner
+ * "Helper" class for creating TCP connections in a non-blocking manner.
+ * The hostname is resolved in the background, after which the resolved addresses
+ * are tried one by one with non-blocking connects that are polled from #CheckCallbacks.
  */
 class TCPConnecter {
 private:
-	std::atomic<bool> connected;///< Whether we succeeded in making the connection
-	std::atomic<bool> aborted;  ///< Whether we bailed out (i.e. connection making failed)
-	bool killed;                ///< Whether we got killed
-	SOCKET sock;                ///< The socket we're connecting with
-
-	void Connect();
-
-	static void ThreadEntry(TCPConnecter *param);
+	/** Status of the connection attempt. */
+	enum ConnecterStatus {
+		CS_RESOLVING,  ///< Waiting for the hostname to be resolved
+		CS_CONNECTING, ///< Trying to connect to the resolved addresses
+		CS_CONNECTED,  ///< We succeeded in making the connection
+		CS_FAILED,     ///< We bailed out (i.e. connection making failed)
+	};
+
+	ConnecterStatus status;                          ///< Status of the connection attempt
+	bool killed;                                     ///< Whether we got killed
+	SOCKET sock;                                     ///< The socket we're connecting with
+	std::shared_ptr<NetworkResolveRequest> resolve;  ///< The request to resolve our address, while resolving
+	NetworkAddressList addresses;                    ///< The resolved addresses to try
+	size_t next_address;                             ///< Index of the next address to try
+	std::chrono::steady_clock::time_point attempt_start; ///< Start of the connect to the current address
+
+	void StartAttempt();
+	void CloseAttempt();
 
 protected:
 	/** Address we're connecting to */
@@ -88,8 +105,7 @@ protected:
 
 public:
 	TCPConnecter(const NetworkAddress &address);
-	/** Silence the warnings */
-	virtual ~TCPConnecter() {}
+	virtual ~TCPConnecter();
 
 	/**
 	 * Callback when the connection succeeded.
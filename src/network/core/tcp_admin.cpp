@@ -90,6 +90,10 @@ NetworkRecvStatus NetworkAdminSocketHandler::HandlePacket(Packet *p)
 		case ADMIN_PACKET_SERVER_CMD_LOGGING:     return this->Receive_SERVER_CMD_LOGGING(p);
 		case ADMIN_PACKET_SERVER_RCON_END:        return this->Receive_SERVER_RCON_END(p);
 		case ADMIN_PACKET_SERVER_PONG:            return this->Receive_SERVER_PONG(p);
+		case ADMIN_PACKET_SERVER_PERFORMANCE:     return this->Receive_SERVER_PERFORMANCE(p);
+		case ADMIN_PACKET_SERVER_WORLD_STATE:     return this->Receive_SERVER_WORLD_STATE(p);
+		case ADMIN_PACKET_SERVER_CMD_PROFILE:     return this->Receive_SERVER_CMD_PROFILE(p);
+		case ADMIN_PACKET_SERVER_SLOW_CMD:        return this->Receive_SERVER_SLOW_CMD(p);
 
 		default:
 			if (this->HasClientQuit()) {
@@ -168,3 +172,7 @@ NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_CMD_NAMES(Packet *p)
 NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_CMD_LOGGING(Packet *p) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_CMD_LOGGING); }
 NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_RCON_END(Packet *p) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_RCON_END); }
 NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_PONG(Packet *p) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_PONG); }
+NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_PERFORMANCE(Packet *p) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_PERFORMANCE); }
+NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_WORLD_STATE(Packet *p) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_WORLD_STATE); }
+NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_CMD_PROFILE(Packet *p) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_CMD_PROFILE); }
+NetworkRecvStatus NetworkAdminSocketHandler::Receive_SERVER_SLOW_CMD(Packet *p) { return this->ReceiveInvalidPacket(ADMIN_PACKET_SERVER_SLOW_CMD); }
@@ -59,6 +59,10 @@ enum PacketAdminType {
 	ADMIN_PACKET_SERVER_GAMESCRIPT,      ///< The server gives the admin information from the GameScript in JSON.
 	ADMIN_PACKET_SERVER_RCON_END,        ///< The server indicates that the remote console command has completed.
 	ADMIN_PACKET_SERVER_PONG,            ///< The server replies to a ping request from the admin.
+	ADMIN_PACKET_SERVER_PERFORMANCE,     ///< The server gives the admin its performance measurements.
+	ADMIN_PACKET_SERVER_WORLD_STATE,     ///< The server gives the admin (part of) a world state snapshot.
+	ADMIN_PACKET_SERVER_CMD_PROFILE,     ///< The server gives the admin the accumulated timing of commands.
+	ADMIN_PACKET_SERVER_SLOW_CMD,        ///< The server tells the admin a command took longer than the slow command threshold.
 
 	INVALID_ADMIN_PACKET = 0xFF,         ///< An invalid marker for admin packets.
 };
@@ -82,6 +86,10 @@ enum AdminUpdateType {
 	ADMIN_UPDATE_CMD_NAMES,       ///< The admin would like a list of all DoCommand names.
 	ADMIN_UPDATE_CMD_LOGGING,     ///< The admin would like to have DoCommand information.
 	ADMIN_UPDATE_GAMESCRIPT,      ///< The admin would like to have gamescript messages.
+	ADMIN_UPDATE_PERFORMANCE,     ///< The admin would like to have performance measurements.
+	ADMIN_UPDATE_WORLD_STATE,     ///< The admin would like to have world state snapshots.
+	ADMIN_UPDATE_CMD_PROFILE,     ///< The admin would like to have the accumulated timing of commands.
+	ADMIN_UPDATE_SLOW_CMD,        ///< The admin would like to be told about slow commands.
 	ADMIN_UPDATE_END,             ///< Must ALWAYS be on the end of this list!! (period)
 };
 
@@ -469,6 +477,130 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_PONG(Packet *p);
 
+	/**
+	 * Send the performance measurements of the server, as shown in the framerate window.
+	 *
+	 * NOTICE: Data provided with this packet is not stable and will not be
+	 *         treated as such. Do not rely on element IDs or pool names to be
+	 *         constant across different versions / revisions of OpenTTD.
+	 *
+	 * uint32  Current game date.
+	 * uint8   Number of performance elements to follow.
+	 * For each performance element:
+	 * uint8   ID of the performance element (see #PerformanceElement).
+	 * uint32  Measured rate, in thousandths of cycles per second.
+	 * uint32  Average duration of the last 8 cycles, in microseconds.
+	 * uint32  Average duration of all recorded cycles, in microseconds.
+	 * uint8   Number of pools to follow.
+	 * For each pool:
+	 * string  Name of the pool.
+	 * uint32  Number of items in the pool.
+	 * uint32  Number of pool slots in use, including free slots below the highest used one.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_PERFORMANCE(Packet *p);
+
+	/**
+	 * Send (part of) a world state snapshot. A snapshot consists of multiple packets with
+	 * the same sequence number; the first contains the AWSR_BEGIN record and the last the
+	 * AWSR_END record. A delta snapshot only contains the records which were added or
+	 * changed, and the records which were removed, since the snapshot it is based on.
+	 * uint32  Sequence number of the snapshot.
+	 * uint8   Record type (see #AdminWorldStateRecordType).
+	 * For AWSR_BEGIN:
+	 * uint32  Game date of the snapshot.
+	 * bool    Whether the snapshot is a delta.
+	 * uint32  Sequence number of the snapshot the delta is based on, 0 for full snapshots.
+	 * For AWSR_END:
+	 * uint32  Number of packets in the snapshot, including this one.
+	 * For all other record types:
+	 * uint16  Number of records to follow.
+	 * For each AWSR_VEHICLE record:
+	 * uint32  ID of the vehicle.
+	 * uint8   Type of the vehicle.
+	 * uint8   Owner of the vehicle.
+	 * uint16  Unit number of the vehicle.
+	 * uint32  Tile of the vehicle.
+	 * uint32  X position of the vehicle.
+	 * uint32  Y position of the vehicle.
+	 * uint16  Current speed of the vehicle.
+	 * uint8   State of the vehicle (see #AdminWorldStateVehicleFlags).
+	 * uint16  Index of the current order.
+	 * uint64  Profit this year.
+	 * uint64  Profit last year.
+	 * uint32  Amount of cargo loaded.
+	 * For each AWSR_STATION record:
+	 * uint32  ID of the station.
+	 * uint8   Owner of the station.
+	 * uint32  Tile of the station sign.
+	 * uint8   Number of cargoes to follow.
+	 * For each cargo:
+	 * uint8   Cargo type.
+	 * uint8   Station rating.
+	 * uint32  Amount of cargo waiting.
+	 * For each AWSR_LINK record:
+	 * uint8   Cargo type.
+	 * uint32  ID of the source station.
+	 * uint32  ID of the destination station.
+	 * uint32  Capacity of the link.
+	 * uint32  Usage of the link.
+	 * For each AWSR_VEHICLE_REMOVED and AWSR_STATION_REMOVED record:
+	 * uint32  ID of the vehicle or station.
+	 * For each AWSR_LINK_REMOVED record:
+	 * uint8   Cargo type.
+	 * uint32  ID of the source station.
+	 * uint32  ID of the destination station.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_WORLD_STATE(Packet *p);
+
+	/**
+	 * Send the accumulated timing of commands, per command and company, since the
+	 * start of the server or the last reset. Only commands which have been run are sent.
+	 *
+	 * NOTICE: Data provided with this packet is not stable and will not be
+	 *         treated as such. Do not rely on IDs or names to be constant
+	 *         across different versions / revisions of OpenTTD.
+	 *
+	 * For each entry:
+	 * bool    Data to follow.
+	 * uint16  ID of the command.
+	 * uint8   ID of the company (0..MAX_COMPANIES-1), or 255 for commands not run by a company.
+	 * uint32  Number of times the command was run.
+	 * uint64  Total time spent testing the command, in microseconds.
+	 * uint64  Total time spent executing the command, in microseconds.
+	 * uint32  Longest time of a single run of the command, in microseconds.
+	 * After the last entry:
+	 * bool    No more data to follow in this packet; more packets may follow.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_CMD_PROFILE(Packet *p);
+
+	/**
+	 * Notify the admin that a command took longer than the slow command threshold.
+	 *
+	 * NOTICE: Data provided with this packet is not stable and will not be
+	 *         treated as such. Do not rely on IDs or names to be constant
+	 *         across different versions / revisions of OpenTTD.
+	 *
+	 * uint8   ID of the company (0..MAX_COMPANIES-1), or 255 for commands not run by a company.
+	 * uint16  ID of the command.
+	 * uint32  P1 (variable data passed to the command).
+	 * uint32  P2 (variable data passed to the command).
+	 * uint64  P3 (variable data passed to the command).
+	 * uint32  Tile where this is taking place.
+	 * string  Text passed to the command.
+	 * uint32  Game date the command was run at.
+	 * uint32  Time spent testing the command, in microseconds.
+	 * uint32  Time spent executing the command, in microseconds.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_SLOW_CMD(Packet *p);
+
 	/**
 	 * Notify the admin connection that the rcon command has finished.
 	 * string The command as requested by the admin connection.
@@ -10,12 +10,16 @@
  */
 
 #include "../../stdafx.h"
-#include "../../thread.h"
+#include "../../debug.h"
 
 #include "tcp.h"
+#include "resolver.h"
 
 #include "../../safeguards.h"
 
+static const uint MAX_CONNECT_ATTEMPTS = 16; ///< Maximum number of connects in progress at the same time, over all connecters.
+static const std::chrono::seconds CONNECT_ATTEMPT_TIMEOUT(3); ///< Allow connect() three seconds to connect to each address.
+
 /** List of connections that are currently being created */
 static std::vector<TCPConnecter *> _tcp_connecters;
 
@@ -24,63 +28,157 @@ static std::vector<TCPConnecter *> _tcp_connecters;
  * @param address the (un)resolved address to connect to
  */
 TCPConnecter::TCPConnecter(const NetworkAddress &address) :
-	connected(false),
-	aborted(false),
+	status(CS_RESOLVING),
 	killed(false),
 	sock(INVALID_SOCKET),
+	next_address(0),
 	address(address)
 {
+	DEBUG(net, 1, "Connecting to %s port %u", this->address.GetHostname(), this->address.GetPort());
+
 	_tcp_connecters.push_back(this);
-	if (!StartNewThread(nullptr, "ottd:tcp", &TCPConnecter::ThreadEntry, this)) {
-		this->Connect();
-	}
+	this->resolve = std::make_shared<NetworkResolveRequest>(address, SOCK_STREAM);
+	NetworkResolveAsync(this->resolve);
 }
 
-/** The actual connection function */
-void TCPConnecter::Connect()
+/** Close the connect in progress, if any. */
+TCPConnecter::~TCPConnecter()
 {
-	this->sock = this->address.Connect();
-	if (this->sock == INVALID_SOCKET) {
-		this->aborted = true;
-	} else {
-		this->connected = true;
-	}
+	this->CloseAttempt();
+}
+
+/** Close the connect to the current address. */
+void TCPConnecter::CloseAttempt()
+{
+	if (this->sock != INVALID_SOCKET) closesocket(this->sock);
+	this->sock = INVALID_SOCKET;
 }
 
 /**
- * Entry point for the new threads.
- * @param param the TCPConnecter instance to call Connect on.
+ * Start a non-blocking connect to the next address that does not fail right away.
+ * When there are no addresses left, the connection attempt has failed.
  */
-/* static */ void TCPConnecter::ThreadEntry(TCPConnecter *param)
+void TCPConnecter::StartAttempt()
 {
-	param->Connect();
+	while (this->next_address < this->addresses.size()) {
+		NetworkAddress &address = this->addresses[this->next_address++];
+		const char *family = NetworkAddress::AddressFamilyAsString(address.GetAddress()->ss_family);
+
+		this->sock = socket(address.GetAddress()->ss_family, SOCK_STREAM, IPPROTO_TCP);
+		if (this->sock == INVALID_SOCKET) {
+			DEBUG(net, 1, "[tcp] could not create %s socket: %s", family, NetworkGetLastErrorString());
+			continue;
+		}
+
+		if (!SetNoDelay(this->sock)) DEBUG(net, 1, "[tcp] setting TCP_NODELAY failed");
+
+		if (!SetNonBlocking(this->sock)) DEBUG(net, 0, "[tcp] setting non-blocking mode failed");
+
+		int err = connect(this->sock, (const struct sockaddr *)address.GetAddress(), address.GetAddressLength());
+		if (err != 0 && NetworkGetLastError() != EINPROGRESS) {
+			DEBUG(net, 1, "[tcp] could not connect to %s over %s: %s", NetworkAddressDumper().GetAddressAsString(&address), family, NetworkGetLastErrorString());
+			this->CloseAttempt();
+			continue;
+		}
+
+		this->attempt_start = std::chrono::steady_clock::now();
+		if (err == 0) {
+			DEBUG(net, 1, "[tcp] connected to %s", NetworkAddressDumper().GetAddressAsString(&address));
+			this->status = CS_CONNECTED;
+		}
+		return;
+	}
+
+	this->status = CS_FAILED;
 }
 
 /**
- * Check whether we need to call the callback, i.e. whether we
- * have connected or aborted and call the appropriate callback
- * for that. It's done this way to ease on the locking that
- * would otherwise be needed everywhere.
+ * Progress all connection attempts, and check whether we need to call the
+ * callback, i.e. whether we have connected or aborted and call the
+ * appropriate callback for that. Everything but the resolving of the
+ * hostnames is done here, so no locking is needed.
  */
 /* static */ void TCPConnecter::CheckCallbacks()
 {
+	/* Start connects for the connecters that are not connecting yet, as far as the limit allows. */
+	uint attempts = 0;
+	for (TCPConnecter *cur : _tcp_connecters) {
+		if (cur->sock != INVALID_SOCKET) attempts++;
+	}
+	for (TCPConnecter *cur : _tcp_connecters) {
+		if (cur->killed) continue;
+		if (cur->status == CS_RESOLVING && cur->resolve->done) {
+			cur->addresses = std::move(cur->resolve->results);
+			cur->resolve.reset();
+			cur->status = CS_CONNECTING;
+		}
+		if (cur->status == CS_CONNECTING && cur->sock == INVALID_SOCKET && attempts < MAX_CONNECT_ATTEMPTS) {
+			cur->StartAttempt();
+			if (cur->sock != INVALID_SOCKET) attempts++;
+		}
+	}
+
+	/* Poll the connects in progress, without waiting. */
+	if (attempts > 0) {
+		fd_set write_fd, except_fd;
+		FD_ZERO(&write_fd);
+		FD_ZERO(&except_fd);
+		for (TCPConnecter *cur : _tcp_connecters) {
+			if (cur->status != CS_CONNECTING || cur->sock == INVALID_SOCKET) continue;
+			FD_SET(cur->sock, &write_fd);
+			FD_SET(cur->sock, &except_fd);
+		}
+
+		struct timeval tv;
+		tv.tv_sec = tv.tv_usec = 0;
+		int n = select(FD_SETSIZE, nullptr, &write_fd, &except_fd, &tv);
+		if (n < 0) {
+			DEBUG(net, 1, "[tcp] select() while connecting failed: %s", NetworkGetLastErrorString());
+			FD_ZERO(&write_fd);
+			FD_ZERO(&except_fd);
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		for (TCPConnecter *cur : _tcp_connecters) {
+			if (cur->status != CS_CONNECTING || cur->sock == INVALID_SOCKET) continue;
+
+			NetworkAddress &address = cur->addresses[cur->next_address - 1];
+			if (FD_ISSET(cur->sock, &write_fd) || FD_ISSET(cur->sock, &except_fd)) {
+				int err = GetSocketError(cur->sock);
+				if (err == 0 && !FD_ISSET(cur->sock, &except_fd)) {
+					DEBUG(net, 1, "[tcp] connected to %s", NetworkAddressDumper().GetAddressAsString(&address));
+					cur->status = CS_CONNECTED;
+					continue;
+				}
+				DEBUG(net, 1, "[tcp] could not connect to %s: %s", NetworkAddressDumper().GetAddressAsString(&address), NetworkGetErrorString(err));
+			} else if (now - cur->attempt_start >= CONNECT_ATTEMPT_TIMEOUT) {
+				DEBUG(net, 1, "[tcp] timed out while connecting to %s", NetworkAddressDumper().GetAddressAsString(&address));
+			} else {
+				continue;
+			}
+
+			/* The next address is tried the next time round, so it is subject to the limit again. */
+			cur->CloseAttempt();
+			if (cur->next_address >= cur->addresses.size()) cur->status = CS_FAILED;
+		}
+	}
+
 	for (auto iter = _tcp_connecters.begin(); iter < _tcp_connecters.end(); /* nothing */) {
 		TCPConnecter *cur = *iter;
-		const bool connected = cur->connected.load();
-		const bool aborted = cur->aborted.load();
-		if ((connected || aborted) && cur->killed) {
+		if (cur->killed) {
 			iter = _tcp_connecters.erase(iter);
-			if (cur->sock != INVALID_SOCKET) closesocket(cur->sock);
 			delete cur;
 			continue;
 		}
-		if (connected) {
+		if (cur->status == CS_CONNECTED) {
 			iter = _tcp_connecters.erase(iter);
-			cur->OnConnect(cur->sock);
+			SOCKET s = cur->sock;
+			cur->sock = INVALID_SOCKET;
+			cur->OnConnect(s);
 			delete cur;
 			continue;
 		}
-		if (aborted) {
+		if (cur->status == CS_FAILED) {
 			iter = _tcp_connecters.erase(iter);
 			cur->OnFailure();
 			delete cur;
@@ -125,6 +125,7 @@ enum PacketGameType {
 	PACKET_CLIENT_DESYNC_LOG,            ///< A client reports a desync log
 	PACKET_SERVER_DESYNC_LOG,            ///< A server reports a desync log
 	PACKET_CLIENT_DESYNC_MSG,            ///< A client reports a desync message
+	PACKET_CLIENT_DESYNC_STATE_HASH,     ///< A client reports its state hash tree after a desync
 
 	PACKET_END,                          ///< Must ALWAYS be on the end of this list!! (period)
 };
@@ -452,6 +453,25 @@ protected:
 	virtual NetworkRecvStatus Receive_SERVER_DESYNC_LOG(Packet *p);
 	virtual NetworkRecvStatus Receive_CLIENT_DESYNC_MSG(Packet *p);
 
+	/**
+	 * The client reports (part of) its state hash tree after a desync.
+	 * uint8   0 for the header, 1 for a chunk of leaves.
+	 * Header:
+	 * uint32  Frame the tree was computed at.
+	 * uint32  Date the tree was computed at.
+	 * uint16  Date fraction the tree was computed at.
+	 * uint8   Tick skip counter the tree was computed at.
+	 * uint64  Root hash.
+	 * uint64  Hash of each subsystem, SHS_END times.
+	 * Chunk of leaves:
+	 * uint8   Subsystem of the leaves.
+	 * uint16  Number of leaves.
+	 * uint32  ID of the leaf, and
+	 * uint64  hash of the leaf, for each leaf.
+	 * @param p The packet that was just received.
+	 */
+	virtual NetworkRecvStatus Receive_CLIENT_DESYNC_STATE_HASH(Packet *p);
+
 	/**
 	 * Notification that a client left the game:
 	 * uint32  ID of the client.
@@ -537,6 +557,7 @@ protected:
 	 * Update the clients knowledge of the max settings:
 	 * uint8   Maximum number of companies allowed.
 	 * uint8   Maximum number of spectators allowed.
+	 * bool    Whether the server wants the state hash tree of the client after a desync.
 	 * @param p The packet that was just received.
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_CONFIG_UPDATE(Packet *p);
@@ -583,7 +604,7 @@ public:
 	NetworkRecvStatus ReceivePackets();
 
 	const char *ReceiveCommand(Packet *p, CommandPacket *cp);
-	void SendCommand(Packet *p, const CommandPacket *cp);
+	static void SendCommand(Packet *p, const CommandPacket *cp);
 
 	virtual std::string GetDebugInfo() const;
 	virtual void LogSentPacket(const Packet &pkt) override;
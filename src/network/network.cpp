@@ -22,6 +22,7 @@
 #include "core/udp.h"
 #include "core/host.h"
 #include "network_gui.h"
+#include "network_desync_test.h"
 #include "../console_func.h"
 #include "../3rdparty/md5/md5.h"
 #include "../core/random_func.hpp"
@@ -595,6 +596,7 @@ void NetworkClose(bool close_admins)
 	_network_server = false;
 
 	NetworkFreeLocalCommandQueue();
+	NetworkDesyncTestReset();
 
 	free(_network_company_states);
 	_network_company_states = nullptr;
@@ -816,6 +818,7 @@ bool NetworkServerStart()
 	_frame_counter_max = 0;
 	_last_sync_frame = 0;
 	_network_own_client_id = CLIENT_ID_SERVER;
+	NetworkServerResetSyncStateHashTrees();
 
 	_network_clients_connected = 0;
 	_network_company_passworded = 0;
@@ -1082,6 +1085,8 @@ void NetworkGameLoop()
 #endif
 		_sync_state_checksum = _state_checksum.state;
 
+		NetworkDesyncTestTick();
+
 		NetworkServer_Tick(send_frame);
 	} else {
 		/* Client */
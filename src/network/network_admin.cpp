@@ -20,6 +20,15 @@
 #include "../map_func.h"
 #include "../rev.h"
 #include "../game/game.hpp"
+#include "../framerate_type.h"
+#include "../vehicle_base.h"
+#include "../order_base.h"
+#include "../station_base.h"
+#include "../cargopacket.h"
+#include "../town.h"
+#include "../industry.h"
+#include "../linkgraph/linkgraph.h"
+#include "../linkgraph/linkgraphjob.h"
 
 #include "../safeguards.h"
 
@@ -52,6 +61,10 @@ static const AdminUpdateFrequency _admin_update_type_frequencies[] = {
 	ADMIN_FREQUENCY_POLL,                                                                                                                                  ///< ADMIN_UPDATE_CMD_NAMES
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_CMD_LOGGING
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_GAMESCRIPT
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_PERFORMANCE
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_WORLD_STATE
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_CMD_PROFILE
+	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_SLOW_CMD
 };
 /** Sanity check. */
 static_assert(lengthof(_admin_update_type_frequencies) == ADMIN_UPDATE_END);
@@ -105,6 +118,12 @@ ServerNetworkAdminSocketHandler::~ServerNetworkAdminSocketHandler()
 			as->CloseConnection(true);
 			continue;
 		}
+		if (as->world_state != nullptr) {
+			std::vector<std::unique_ptr<Packet>> packets;
+			if (as->world_state->CollectPackets(packets)) {
+				for (auto &p : packets) as->SendPacket(std::move(p));
+			}
+		}
 		if (as->writable) {
 			as->SendPackets();
 		}
@@ -607,6 +626,62 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::SendPong(uint32 d1)
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/**
+ * Append the item counts of a pool to a performance packet.
+ * @param p The packet to append to.
+ * @param pool The pool.
+ */
+template <typename Tpool>
+static void SendPoolPerformance(Packet *p, const Tpool &pool)
+{
+	p->Send_string(pool.name);
+	p->Send_uint32((uint32)pool.items);
+	p->Send_uint32((uint32)pool.first_unused);
+}
+
+/** Send the performance measurements and pool sizes. */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendPerformance()
+{
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_PERFORMANCE);
+
+	p->Send_uint32(_date);
+
+	struct ElementSummary {
+		PerformanceElement elem;
+		double rate;
+		double short_term_ms;
+		double long_term_ms;
+	};
+	std::vector<ElementSummary> elements;
+	for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
+		ElementSummary summary;
+		summary.elem = e;
+		if (GetPerformanceElementSummary(e, summary.rate, summary.short_term_ms, summary.long_term_ms)) elements.push_back(summary);
+	}
+	p->Send_uint8((uint8)elements.size());
+	for (const ElementSummary &summary : elements) {
+		p->Send_uint8(summary.elem);
+		p->Send_uint32((uint32)(summary.rate * 1000));
+		p->Send_uint32((uint32)(summary.short_term_ms * 1000));
+		p->Send_uint32((uint32)(summary.long_term_ms * 1000));
+	}
+
+	p->Send_uint8(9);
+	SendPoolPerformance(p, _company_pool);
+	SendPoolPerformance(p, _vehicle_pool);
+	SendPoolPerformance(p, _order_pool);
+	SendPoolPerformance(p, _station_pool);
+	SendPoolPerformance(p, _cargopacket_pool);
+	SendPoolPerformance(p, _town_pool);
+	SendPoolPerformance(p, _industry_pool);
+	SendPoolPerformance(p, _link_graph_pool);
+	SendPoolPerformance(p, _link_graph_job_pool);
+
+	this->SendPacket(p);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /** Send the names of the commands. */
 NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCmdNames()
 {
@@ -637,6 +712,17 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCmdNames()
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/**
+ * Request a world state snapshot to be sent.
+ * The snapshot is captured now, but it is encoded in the background and sent once that has finished.
+ * @param full Whether to send a full snapshot instead of a delta against the previously sent snapshot.
+ */
+void ServerNetworkAdminSocketHandler::SendWorldState(bool full)
+{
+	if (this->world_state == nullptr) this->world_state.reset(new AdminWorldStateExport());
+	this->world_state->Request(full);
+}
+
 /**
  * Send a command for logging purposes.
  * @param client_id The client executing the command.
@@ -660,6 +746,68 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCmdLogging(ClientID clien
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/**
+ * Send the accumulated timing of commands.
+ */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCmdProfile()
+{
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_CMD_PROFILE);
+
+	for (uint cmd = 0; cmd < CMD_END; cmd++) {
+		for (uint slot = 0; slot <= COMMAND_PROFILE_OTHER_COMPANY; slot++) {
+			const CommandProfileEntry &entry = GetCommandProfileEntry(cmd, slot);
+			if (entry.count == 0) continue;
+
+			/* Should COMPAT_MTU be exceeded, start a new packet
+			 * (magic 29: 1 bool "more data", the entry of 27 bytes and 1 bool "no more data") */
+			if (!p->CanWriteToPacket(29)) {
+				p->Send_bool(false);
+				this->SendPacket(p);
+
+				p = new Packet(ADMIN_PACKET_SERVER_CMD_PROFILE);
+			}
+
+			p->Send_bool(true);
+			p->Send_uint16(cmd);
+			p->Send_uint8(slot == COMMAND_PROFILE_OTHER_COMPANY ? (uint)COMPANY_SPECTATOR : slot);
+			p->Send_uint32(entry.count);
+			p->Send_uint64(entry.test_time);
+			p->Send_uint64(entry.exec_time);
+			p->Send_uint32(entry.max_time);
+		}
+	}
+
+	/* Marker to notify the end of the packet has been reached. */
+	p->Send_bool(false);
+	this->SendPacket(p);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+/**
+ * Send a command which took longer than the slow command threshold.
+ * @param entry The slow command.
+ */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendSlowCmd(const SlowCommandLogEntry &entry)
+{
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_SLOW_CMD);
+
+	p->Send_uint8 (entry.company < MAX_COMPANIES ? (uint8)entry.company : (uint8)COMPANY_SPECTATOR);
+	p->Send_uint16(entry.cmd & CMD_ID_MASK);
+	p->Send_uint32(entry.p1);
+	p->Send_uint32(entry.p2);
+	p->Send_uint64(entry.p3);
+	p->Send_uint32(entry.tile);
+	p->Send_string(entry.text.c_str());
+	p->Send_uint32(entry.date);
+	p->Send_uint32(entry.test_time);
+	p->Send_uint32(entry.exec_time);
+
+	this->SendPacket(p);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /***********
  * Receiving functions
  ************/
@@ -775,6 +923,21 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_POLL(Packet *p)
 			this->SendCmdNames();
 			break;
 
+		case ADMIN_UPDATE_PERFORMANCE:
+			/* The admin is requesting performance measurements. */
+			this->SendPerformance();
+			break;
+
+		case ADMIN_UPDATE_WORLD_STATE:
+			/* The admin is requesting a world state snapshot; UINT32_MAX asks for a full one instead of a delta. */
+			this->SendWorldState(d1 == UINT32_MAX);
+			break;
+
+		case ADMIN_UPDATE_CMD_PROFILE:
+			/* The admin is requesting the timing of commands. */
+			this->SendCmdProfile();
+			break;
+
 		default:
 			/* An unsupported "poll" update type. */
 			DEBUG(net, 3, "[admin] Not supported poll %d (%d) from '%s' (%s).", type, d1, this->admin_name, this->admin_version);
@@ -990,6 +1153,19 @@ void NetworkAdminCmdLogging(const NetworkClientSocket *owner, const CommandPacke
 	}
 }
 
+/**
+ * Distribute a command which took longer than the slow command threshold over the admin network.
+ * @param entry The slow command.
+ */
+void NetworkAdminSlowCommand(const SlowCommandLogEntry &entry)
+{
+	for (ServerNetworkAdminSocketHandler *as : ServerNetworkAdminSocketHandler::IterateActive()) {
+		if (as->update_frequency[ADMIN_UPDATE_SLOW_CMD] & ADMIN_FREQUENCY_AUTOMATIC) {
+			as->SendSlowCmd(entry);
+		}
+	}
+}
+
 /**
  * Send a Welcome packet to all connected admins
  */
@@ -1023,6 +1199,18 @@ void NetworkAdminUpdate(AdminUpdateFrequency freq)
 						as->SendCompanyStats();
 						break;
 
+					case ADMIN_UPDATE_PERFORMANCE:
+						as->SendPerformance();
+						break;
+
+					case ADMIN_UPDATE_WORLD_STATE:
+						as->SendWorldState(false);
+						break;
+
+					case ADMIN_UPDATE_CMD_PROFILE:
+						as->SendCmdProfile();
+						break;
+
 					default: NOT_REACHED();
 				}
 			}
@@ -13,6 +13,8 @@
 #include "network_internal.h"
 #include "core/tcp_listen.h"
 #include "core/tcp_admin.h"
+#include "network_admin_world_state.h"
+#include "../command_profile.h"
 
 extern AdminIndex _redirect_console_to_admin;
 
@@ -39,6 +41,7 @@ public:
 	AdminUpdateFrequency update_frequency[ADMIN_UPDATE_END]; ///< Admin requested update intervals.
 	std::chrono::steady_clock::time_point connect_time;      ///< Time of connection.
 	NetworkAddress address;                                  ///< Address of the admin.
+	std::unique_ptr<AdminWorldStateExport> world_state;      ///< World state export, if the admin requested any.
 
 	ServerNetworkAdminSocketHandler(SOCKET s);
 	~ServerNetworkAdminSocketHandler();
@@ -66,6 +69,10 @@ public:
 	NetworkRecvStatus SendConsole(const char *origin, const char *command);
 	NetworkRecvStatus SendGameScript(const char *json);
 	NetworkRecvStatus SendCmdNames();
+	NetworkRecvStatus SendPerformance();
+	void SendWorldState(bool full);
+	NetworkRecvStatus SendCmdProfile();
+	NetworkRecvStatus SendSlowCmd(const SlowCommandLogEntry &entry);
 	NetworkRecvStatus SendCmdLogging(ClientID client_id, const CommandPacket *cp);
 	NetworkRecvStatus SendRconEnd(const char *command);
 
@@ -112,5 +119,6 @@ void NetworkServerSendAdminRcon(AdminIndex admin_index, TextColour colour_code,
 void NetworkAdminConsole(const char *origin, const char *string);
 void NetworkAdminGameScript(const char *json);
 void NetworkAdminCmdLogging(const NetworkClientSocket *owner, const CommandPacket *cp);
+void NetworkAdminSlowCommand(const SlowCommandLogEntry &entry);
 
 #endif /* NETWORK_ADMIN_H */
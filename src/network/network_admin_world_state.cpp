@@ -0,0 +1,307 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file network_admin_world_state.cpp Export of world state snapshots to the admin network. */
+
+#include "../stdafx.h"
+#include "network_admin_world_state.h"
+#include "core/tcp_admin.h"
+#include "../date_func.h"
+#include "../vehicle_base.h"
+#include "../station_base.h"
+#include "../linkgraph/linkgraph.h"
+#include "../thread.h"
+#include <algorithm>
+
+#include "../safeguards.h"
+
+/** Space in a packet for records, after the packet header and the world state record header. */
+static const size_t WORLD_STATE_PACKET_SPACE = COMPAT_MTU - sizeof(PacketSize) - sizeof(PacketType) - sizeof(uint32) - sizeof(uint8) - sizeof(uint16);
+
+bool AdminWorldStateSnapshot::VehicleRecord::operator==(const VehicleRecord &other) const
+{
+	return this->id == other.id && this->type == other.type && this->owner == other.owner && this->unitnumber == other.unitnumber &&
+			this->tile == other.tile && this->x == other.x && this->y == other.y && this->speed == other.speed &&
+			this->state == other.state && this->order_index == other.order_index && this->profit_this_year == other.profit_this_year &&
+			this->profit_last_year == other.profit_last_year && this->cargo == other.cargo;
+}
+
+/**
+ * Copy the exported parts of the current world state.
+ * This must be called from the game thread, everything else works on the copy.
+ */
+void AdminWorldStateSnapshot::Capture()
+{
+	this->date = _date;
+
+	this->vehicles.clear();
+	for (const Vehicle *v : Vehicle::Iterate()) {
+		if (!v->IsPrimaryVehicle()) continue;
+
+		VehicleRecord &r = this->vehicles.emplace_back();
+		r.id = v->index;
+		r.type = v->type;
+		r.owner = v->owner;
+		r.unitnumber = v->unitnumber;
+		r.tile = v->tile;
+		r.x = v->x_pos;
+		r.y = v->y_pos;
+		r.speed = v->cur_speed;
+		r.state = 0;
+		if (v->vehstatus & VS_STOPPED) r.state |= AWSVF_STOPPED;
+		if (v->vehstatus & VS_CRASHED) r.state |= AWSVF_CRASHED;
+		if (v->IsInDepot()) r.state |= AWSVF_IN_DEPOT;
+		if (v->breakdown_ctr == 1) r.state |= AWSVF_BROKEN_DOWN;
+		r.order_index = v->cur_real_order_index;
+		r.profit_this_year = v->GetDisplayProfitThisYear();
+		r.profit_last_year = v->GetDisplayProfitLastYear();
+		r.cargo = 0;
+		for (const Vehicle *u = v; u != nullptr; u = u->Next()) {
+			r.cargo += u->cargo.StoredCount();
+		}
+	}
+
+	this->stations.clear();
+	for (const Station *st : Station::Iterate()) {
+		StationRecord &r = this->stations.emplace_back();
+		r.id = st->index;
+		r.owner = st->owner;
+		r.tile = st->xy;
+		for (CargoID c = 0; c < NUM_CARGO; c++) {
+			const GoodsEntry &ge = st->goods[c];
+			uint waiting = ge.cargo.TotalCount();
+			if (!ge.HasRating() && waiting == 0) continue;
+			r.cargo.push_back({ c, ge.rating, waiting });
+		}
+	}
+
+	this->links.clear();
+	for (const LinkGraph *lg : LinkGraph::Iterate()) {
+		for (NodeID from = 0; from < lg->Size(); from++) {
+			LinkGraph::ConstNode node = (*lg)[from];
+			for (LinkGraph::ConstEdgeIterator it = node.Begin(); it != node.End(); ++it) {
+				StationID to = (*lg)[it->first].Station();
+				if (to == node.Station()) continue;
+				this->links.push_back({ lg->Cargo(), node.Station(), to, it->second.Capacity(), it->second.Usage() });
+			}
+		}
+	}
+	std::sort(this->links.begin(), this->links.end(), [](const LinkRecord &a, const LinkRecord &b) { return a.Key() < b.Key(); });
+}
+
+/**
+ * Determine the records which are new or changed, and the keys of the records which have been removed.
+ * Both \a previous and \a current must be sorted by key.
+ * @param previous Records of the previous snapshot.
+ * @param current Records of the current snapshot.
+ * @param changed Output for the new and changed records.
+ * @param removed Output for the removed records.
+ * @param key Function returning the key of a record.
+ */
+template <typename T, typename Tkey>
+static void DiffWorldStateRecords(const std::vector<T> &previous, const std::vector<T> &current, std::vector<const T *> &changed, std::vector<const T *> &removed, Tkey key)
+{
+	auto prev = previous.begin();
+	auto cur = current.begin();
+	while (prev != previous.end() || cur != current.end()) {
+		if (cur == current.end() || (prev != previous.end() && key(*prev) < key(*cur))) {
+			removed.push_back(&*prev);
+			++prev;
+		} else if (prev == previous.end() || key(*cur) < key(*prev)) {
+			changed.push_back(&*cur);
+			++cur;
+		} else {
+			if (!(*prev == *cur)) changed.push_back(&*cur);
+			++prev;
+			++cur;
+		}
+	}
+}
+
+/**
+ * Encode records into as many packets as needed.
+ * Each packet contains the sequence number, the record type, the number of records and then the records.
+ * @param packets Output for the packets.
+ * @param sequence Sequence number of the snapshot.
+ * @param type Type of the records.
+ * @param records Records to encode.
+ * @param size Function returning the encoded size of a record.
+ * @param write Function writing a record to a packet.
+ */
+template <typename T, typename Tsize, typename Twrite>
+static void EncodeWorldStateRecords(std::vector<std::unique_ptr<Packet>> &packets, uint32 sequence, AdminWorldStateRecordType type, const std::vector<const T *> &records, Tsize size, Twrite write)
+{
+	size_t first = 0;
+	while (first < records.size()) {
+		size_t last = first;
+		size_t used = 0;
+		while (last < records.size() && last - first < UINT16_MAX && used + size(*records[last]) <= WORLD_STATE_PACKET_SPACE) {
+			used += size(*records[last]);
+			last++;
+		}
+		assert(last > first);
+
+		Packet *p = new Packet(ADMIN_PACKET_SERVER_WORLD_STATE);
+		p->Send_uint32(sequence);
+		p->Send_uint8(type);
+		p->Send_uint16((uint16)(last - first));
+		for (size_t i = first; i < last; i++) write(p, *records[i]);
+		packets.emplace_back(p);
+
+		first = last;
+	}
+}
+
+/**
+ * Encode the current snapshot, either completely or as delta against the previous snapshot.
+ * This runs on the worker thread.
+ */
+void AdminWorldStateExport::Encode()
+{
+	typedef AdminWorldStateSnapshot::VehicleRecord VehicleRecord;
+	typedef AdminWorldStateSnapshot::StationRecord StationRecord;
+	typedef AdminWorldStateSnapshot::LinkRecord LinkRecord;
+
+	static const AdminWorldStateSnapshot empty;
+	const AdminWorldStateSnapshot &base = this->current_is_delta ? *this->previous : empty;
+	const AdminWorldStateSnapshot &snapshot = *this->current;
+
+	std::vector<const VehicleRecord *> vehicles, removed_vehicles;
+	std::vector<const StationRecord *> stations, removed_stations;
+	std::vector<const LinkRecord *> links, removed_links;
+	DiffWorldStateRecords(base.vehicles, snapshot.vehicles, vehicles, removed_vehicles, [](const VehicleRecord &r) { return r.id; });
+	DiffWorldStateRecords(base.stations, snapshot.stations, stations, removed_stations, [](const StationRecord &r) { return r.id; });
+	DiffWorldStateRecords(base.links, snapshot.links, links, removed_links, [](const LinkRecord &r) { return r.Key(); });
+
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_WORLD_STATE);
+	p->Send_uint32(this->sequence);
+	p->Send_uint8(AWSR_BEGIN);
+	p->Send_uint32(snapshot.date);
+	p->Send_bool(this->current_is_delta);
+	p->Send_uint32(this->current_is_delta ? this->sequence - 1 : 0);
+	this->packets.emplace_back(p);
+
+	EncodeWorldStateRecords(this->packets, this->sequence, AWSR_VEHICLE, vehicles, [](const VehicleRecord &) -> size_t { return 45; }, [](Packet *p, const VehicleRecord &r) {
+		p->Send_uint32(r.id);
+		p->Send_uint8(r.type);
+		p->Send_uint8(r.owner);
+		p->Send_uint16(r.unitnumber);
+		p->Send_uint32(r.tile);
+		p->Send_uint32(r.x);
+		p->Send_uint32(r.y);
+		p->Send_uint16(r.speed);
+		p->Send_uint8(r.state);
+		p->Send_uint16(r.order_index);
+		p->Send_uint64(r.profit_this_year);
+		p->Send_uint64(r.profit_last_year);
+		p->Send_uint32(r.cargo);
+	});
+	EncodeWorldStateRecords(this->packets, this->sequence, AWSR_VEHICLE_REMOVED, removed_vehicles, [](const VehicleRecord &) -> size_t { return 4; }, [](Packet *p, const VehicleRecord &r) {
+		p->Send_uint32(r.id);
+	});
+
+	EncodeWorldStateRecords(this->packets, this->sequence, AWSR_STATION, stations, [](const StationRecord &r) -> size_t { return 10 + r.cargo.size() * 6; }, [](Packet *p, const StationRecord &r) {
+		p->Send_uint32(r.id);
+		p->Send_uint8(r.owner);
+		p->Send_uint32(r.tile);
+		p->Send_uint8((uint8)r.cargo.size());
+		for (const AdminWorldStateSnapshot::StationCargoRecord &c : r.cargo) {
+			p->Send_uint8(c.cargo);
+			p->Send_uint8(c.rating);
+			p->Send_uint32(c.waiting);
+		}
+	});
+	EncodeWorldStateRecords(this->packets, this->sequence, AWSR_STATION_REMOVED, removed_stations, [](const StationRecord &) -> size_t { return 4; }, [](Packet *p, const StationRecord &r) {
+		p->Send_uint32(r.id);
+	});
+
+	EncodeWorldStateRecords(this->packets, this->sequence, AWSR_LINK, links, [](const LinkRecord &) -> size_t { return 17; }, [](Packet *p, const LinkRecord &r) {
+		p->Send_uint8(r.cargo);
+		p->Send_uint32(r.from);
+		p->Send_uint32(r.to);
+		p->Send_uint32(r.capacity);
+		p->Send_uint32(r.usage);
+	});
+	EncodeWorldStateRecords(this->packets, this->sequence, AWSR_LINK_REMOVED, removed_links, [](const LinkRecord &) -> size_t { return 9; }, [](Packet *p, const LinkRecord &r) {
+		p->Send_uint8(r.cargo);
+		p->Send_uint32(r.from);
+		p->Send_uint32(r.to);
+	});
+
+	p = new Packet(ADMIN_PACKET_SERVER_WORLD_STATE);
+	p->Send_uint32(this->sequence);
+	p->Send_uint8(AWSR_END);
+	p->Send_uint32((uint32)this->packets.size() + 1);
+	this->packets.emplace_back(p);
+}
+
+/**
+ * Capture a snapshot and start encoding it.
+ * @param full Whether to send a full snapshot instead of a delta against the previous one.
+ */
+void AdminWorldStateExport::Start(bool full)
+{
+	assert(!this->busy);
+
+	this->current.reset(new AdminWorldStateSnapshot());
+	this->current->Capture();
+	this->current_is_delta = !full && this->previous != nullptr;
+	this->sequence++;
+	this->busy = true;
+
+	if (!StartNewThread(&this->thread, "ottd:adminstate", [](AdminWorldStateExport *self) {
+				self->Encode();
+				self->busy = false;
+			}, this)) {
+		this->Encode();
+		this->busy = false;
+	}
+}
+
+/** Wait for the worker thread, if any. */
+AdminWorldStateExport::~AdminWorldStateExport()
+{
+	if (this->thread.joinable()) this->thread.join();
+}
+
+/**
+ * Request a snapshot to be sent.
+ * When a snapshot is still being encoded, the request is performed once that has finished.
+ * @param full Whether to send a full snapshot instead of a delta against the previous one.
+ */
+void AdminWorldStateExport::Request(bool full)
+{
+	if (this->busy || this->current != nullptr) {
+		this->pending = true;
+		this->pending_full |= full;
+		return;
+	}
+	this->Start(full);
+}
+
+/**
+ * Collect the packets of a finished snapshot, and start the next requested snapshot if any.
+ * @param out Output for the packets, in the order they have to be sent.
+ * @return Whether any packets were collected.
+ */
+bool AdminWorldStateExport::CollectPackets(std::vector<std::unique_ptr<Packet>> &out)
+{
+	if (this->current == nullptr || this->busy) return false;
+	if (this->thread.joinable()) this->thread.join();
+
+	for (auto &p : this->packets) out.push_back(std::move(p));
+	this->packets.clear();
+	this->previous = std::move(this->current);
+
+	if (this->pending) {
+		bool full = this->pending_full;
+		this->pending = false;
+		this->pending_full = false;
+		this->Start(full);
+	}
+	return true;
+}
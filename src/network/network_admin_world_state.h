@@ -0,0 +1,140 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file network_admin_world_state.h Export of world state snapshots to the admin network. */
+
+#ifndef NETWORK_ADMIN_WORLD_STATE_H
+#define NETWORK_ADMIN_WORLD_STATE_H
+
+#include "core/packet.h"
+#include "../date_type.h"
+#include "../cargo_type.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+
+/** Compact copy of the parts of the world state which are exported to admins. */
+struct AdminWorldStateSnapshot {
+	/** Exported state of a primary vehicle. */
+	struct VehicleRecord {
+		uint32 id;             ///< Vehicle ID
+		uint8 type;            ///< Vehicle type
+		uint8 owner;           ///< Owner of the vehicle
+		uint16 unitnumber;     ///< Unit number
+		uint32 tile;           ///< Current tile
+		int32 x;               ///< X position, in tile sub-units
+		int32 y;               ///< Y position, in tile sub-units
+		uint16 speed;          ///< Current speed, in vehicle type specific units
+		uint8 state;           ///< Combination of AdminWorldStateVehicleFlags
+		uint16 order_index;    ///< Index of the current real order
+		int64 profit_this_year; ///< Profit this year
+		int64 profit_last_year; ///< Profit last year
+		uint32 cargo;          ///< Amount of cargo loaded in the whole consist
+
+		bool operator==(const VehicleRecord &other) const;
+	};
+
+	/** Exported state of one cargo at a station. */
+	struct StationCargoRecord {
+		uint8 cargo;           ///< Cargo type
+		uint8 rating;          ///< Station rating of the cargo
+		uint32 waiting;        ///< Amount of cargo waiting
+
+		bool operator==(const StationCargoRecord &other) const
+		{
+			return this->cargo == other.cargo && this->rating == other.rating && this->waiting == other.waiting;
+		}
+	};
+
+	/** Exported state of a station. */
+	struct StationRecord {
+		uint32 id;             ///< Station ID
+		uint8 owner;           ///< Owner of the station
+		uint32 tile;           ///< Location of the station sign
+		std::vector<StationCargoRecord> cargo; ///< Cargoes with a rating or waiting cargo
+
+		bool operator==(const StationRecord &other) const
+		{
+			return this->id == other.id && this->owner == other.owner && this->tile == other.tile && this->cargo == other.cargo;
+		}
+	};
+
+	/** Exported state of a link graph edge. */
+	struct LinkRecord {
+		uint8 cargo;           ///< Cargo type
+		uint32 from;           ///< Source station ID
+		uint32 to;             ///< Destination station ID
+		uint32 capacity;       ///< Capacity of the link
+		uint32 usage;          ///< Usage of the link
+
+		/** Ordering key of the link, links are unique per key. */
+		uint64 Key() const { return ((uint64)this->cargo << 48) | ((uint64)this->from << 24) | this->to; }
+
+		bool operator==(const LinkRecord &other) const
+		{
+			return this->Key() == other.Key() && this->capacity == other.capacity && this->usage == other.usage;
+		}
+	};
+
+	Date date = 0;                        ///< Date the snapshot was taken at
+	std::vector<VehicleRecord> vehicles;  ///< Primary vehicles, sorted by ID
+	std::vector<StationRecord> stations;  ///< Stations, sorted by ID
+	std::vector<LinkRecord> links;        ///< Link graph edges, sorted by key
+
+	void Capture();
+};
+
+/** Flags of the state of an exported vehicle. */
+enum AdminWorldStateVehicleFlags : uint8 {
+	AWSVF_STOPPED     = 1 << 0, ///< The vehicle is stopped.
+	AWSVF_CRASHED     = 1 << 1, ///< The vehicle is crashed.
+	AWSVF_IN_DEPOT    = 1 << 2, ///< The vehicle is inside a depot.
+	AWSVF_BROKEN_DOWN = 1 << 3, ///< The vehicle is broken down.
+};
+
+/** Kinds of records in a world state packet. */
+enum AdminWorldStateRecordType : uint8 {
+	AWSR_BEGIN,            ///< Start of a snapshot.
+	AWSR_VEHICLE,          ///< New or changed vehicles.
+	AWSR_VEHICLE_REMOVED,  ///< Removed vehicles.
+	AWSR_STATION,          ///< New or changed stations.
+	AWSR_STATION_REMOVED,  ///< Removed stations.
+	AWSR_LINK,             ///< New or changed link graph edges.
+	AWSR_LINK_REMOVED,     ///< Removed link graph edges.
+	AWSR_END,              ///< End of a snapshot.
+};
+
+/**
+ * Export of world state snapshots for one admin.
+ * Snapshots are captured on the game thread, compared with the previous snapshot
+ * and encoded into packets on a worker thread, and finally queued for sending
+ * on the game thread again.
+ */
+class AdminWorldStateExport {
+	std::thread thread;                                ///< Worker thread encoding the current snapshot
+	std::atomic<bool> busy;                            ///< Whether a snapshot is being encoded
+	std::unique_ptr<AdminWorldStateSnapshot> current;  ///< Snapshot being encoded
+	std::unique_ptr<AdminWorldStateSnapshot> previous; ///< Last sent snapshot, base of the next delta
+	std::vector<std::unique_ptr<Packet>> packets;      ///< Encoded packets of the current snapshot
+	uint32 sequence = 0;                               ///< Sequence number of the last started snapshot
+	bool current_is_delta = false;                     ///< Whether the current snapshot is encoded as delta
+	bool pending = false;                              ///< Whether another snapshot was requested while busy
+	bool pending_full = false;                         ///< Whether the pending snapshot must be a full one
+
+	void Encode();
+	void Start(bool full);
+
+public:
+	AdminWorldStateExport() : busy(false) {}
+	~AdminWorldStateExport();
+
+	void Request(bool full);
+	bool CollectPackets(std::vector<std::unique_ptr<Packet>> &out);
+};
+
+#endif /* NETWORK_ADMIN_WORLD_STATE_H */
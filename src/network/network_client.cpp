@@ -33,6 +33,7 @@
 #include "../core/checksum_func.hpp"
 #include "../fileio_func.h"
 #include "../debug_settings.h"
+#include "../state_hash.h"
 
 #include "table/strings.h"
 
@@ -328,6 +329,12 @@ void ClientNetworkGameSocketHandler::ClientError(NetworkRecvStatus res)
 						, _date, _date_fract, _tick_skip_counter, _sync_seed_1, _sync_state_checksum, _random.state[0], _state_checksum.state);
 				DEBUG(net, 0, "Sync error detected!");
 
+				if (my_client->desync_state_hash_requested) {
+					StateHashTree tree;
+					tree.Compute(_frame_counter);
+					my_client->SendDesyncStateHash(tree);
+				}
+
 				std::string desync_log;
 				info.log_file = &(my_client->desync_log_file);
 				CrashLog::DesyncCrashLog(nullptr, &desync_log, info);
@@ -574,6 +581,46 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::SendDesyncLog(const std::strin
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/**
+ * Send our state hash tree to the server after a desync, so it can determine where the game states differ.
+ * @param tree The state hash tree at the desync frame.
+ */
+NetworkRecvStatus ClientNetworkGameSocketHandler::SendDesyncStateHash(const StateHashTree &tree)
+{
+	Packet *p = new Packet(PACKET_CLIENT_DESYNC_STATE_HASH, SHRT_MAX);
+	p->Send_uint8(0);
+	p->Send_uint32(tree.frame);
+	p->Send_uint32(tree.date);
+	p->Send_uint16(tree.date_fract);
+	p->Send_uint8(tree.tick_skip_counter);
+	p->Send_uint64(tree.root);
+	for (uint i = 0; i < SHS_END; i++) {
+		p->Send_uint64(tree.subsystems[i]);
+	}
+	my_client->SendPacket(p);
+
+	/* Header: packet size, type, chunk type, subsystem and leaf count; then 12 bytes per leaf. */
+	const size_t max_leaves_per_packet = (SHRT_MAX - 8) / 12;
+	for (uint i = 0; i < SHS_END; i++) {
+		const std::vector<StateHashTree::Leaf> &leaves = tree.leaves[i];
+		for (size_t offset = 0; offset < leaves.size();) {
+			const size_t count = std::min<size_t>(leaves.size() - offset, max_leaves_per_packet);
+			p = new Packet(PACKET_CLIENT_DESYNC_STATE_HASH, SHRT_MAX);
+			p->Send_uint8(1);
+			p->Send_uint8(i);
+			p->Send_uint16((uint16)count);
+			for (size_t j = offset; j < offset + count; j++) {
+				p->Send_uint32(leaves[j].id);
+				p->Send_uint64(leaves[j].hash);
+			}
+			my_client->SendPacket(p);
+
+			offset += count;
+		}
+	}
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /** Send an error-packet over the network */
 NetworkRecvStatus ClientNetworkGameSocketHandler::SendDesyncMessage(const char *msg)
 {
@@ -1308,6 +1355,7 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_CONFIG_UPDATE(P
 
 	_network_server_max_companies = p->Recv_uint8();
 	_network_server_max_spectators = p->Recv_uint8();
+	this->desync_state_hash_requested = p->Recv_bool();
 
 	return NETWORK_RECV_STATUS_OKAY;
 }
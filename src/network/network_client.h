@@ -12,6 +12,8 @@
 
 #include "network_internal.h"
 
+struct StateHashTree;
+
 /** Class for handling the client side of the game connection. */
 class ClientNetworkGameSocketHandler : public NetworkGameSocketHandler {
 private:
@@ -39,6 +41,7 @@ private:
 	FILE *desync_log_file = nullptr;
 	std::string server_desync_log;
 	bool emergency_save_done = false;
+	bool desync_state_hash_requested = false; ///< Whether the server wants our state hash tree after a desync.
 
 	static const char *GetServerStatusName(ServerStatus status);
 
@@ -96,6 +99,7 @@ public:
 	static NetworkRecvStatus SendCommand(const CommandPacket *cp);
 	static NetworkRecvStatus SendError(NetworkErrorCode errorno, NetworkRecvStatus recvstatus = NETWORK_RECV_STATUS_OKAY);
 	static NetworkRecvStatus SendDesyncLog(const std::string &log);
+	static NetworkRecvStatus SendDesyncStateHash(const StateHashTree &tree);
 	static NetworkRecvStatus SendDesyncMessage(const char *msg);
 	static NetworkRecvStatus SendQuit();
 	static NetworkRecvStatus SendAck();
@@ -11,6 +11,7 @@
 #include "network_admin.h"
 #include "network_client.h"
 #include "network_server.h"
+#include "network_desync_test.h"
 #include "../command_func.h"
 #include "../company_func.h"
 #include "../settings_type.h"
@@ -199,10 +200,14 @@ void NetworkSendCommand(TileIndex tile, uint32 p1, uint32 p2, uint64 p3, uint32
  */
 void NetworkSyncCommandQueue(NetworkClientSocket *cs)
 {
+	std::vector<std::vector<byte>> blocks;
 	for (CommandPacket *p = _local_execution_queue.Peek(); p != nullptr; p = p->next) {
 		CommandPacket c = *p;
 		c.callback = 0;
-		cs->outgoing_queue.Append(std::move(c));
+		ServerNetworkGameSocketHandler::EncodeCommand(blocks, &c);
+	}
+	for (std::vector<byte> &block : blocks) {
+		cs->outgoing_commands.push_back(std::make_shared<const std::vector<byte>>(std::move(block)));
 	}
 }
 
@@ -230,6 +235,7 @@ void NetworkExecuteLocalCommandQueue()
 		/* We can execute this command */
 		_current_company = cp->company;
 		cp->cmd |= CMD_NETWORK_COMMAND;
+		if (_network_server) NetworkDesyncTestRecordCommand(cp);
 		DoCommandP(cp, cp->my_cmd);
 
 		queue.Pop();
@@ -248,24 +254,34 @@ void NetworkFreeLocalCommandQueue()
 	_local_execution_queue.Free();
 }
 
+/** Encoded commands of one queue, in the form sent to the owner of the queue and to all other clients. */
+struct EncodedCommandBlocks {
+	std::vector<std::vector<byte>> owner;  ///< Commands with callbacks, for the client that sent them
+	std::vector<std::vector<byte>> others; ///< Commands without callbacks, for all other clients
+};
+
 /**
  * "Send" a particular CommandPacket to all clients.
- * @param cp    The command that has to be distributed.
- * @param owner The client that owns the command,
+ * The command is only encoded once for all clients besides the owner.
+ * @param cp      The command that has to be distributed.
+ * @param owner   The client that owns the command,
+ * @param encoded The blocks to append the encoded command to.
  */
-static void DistributeCommandPacket(CommandPacket &cp, const NetworkClientSocket *owner)
+static void DistributeCommandPacket(CommandPacket &cp, const NetworkClientSocket *owner, EncodedCommandBlocks &encoded)
 {
 	CommandCallback *callback = cp.callback;
 	cp.frame = _frame_counter_max + 1;
 
-	for (NetworkClientSocket *cs : NetworkClientSocket::Iterate()) {
-		if (cs->status >= NetworkClientSocket::STATUS_MAP) {
-			/* Callbacks are only send back to the client who sent them in the
-			 *  first place. This filters that out. */
-			cp.callback = (cs != owner) ? nullptr : callback;
-			cp.my_cmd = (cs == owner);
-			cs->outgoing_queue.Append(cp);
-		}
+	/* Callbacks are only send back to the client who sent them in the
+	 *  first place. This filters that out. */
+	cp.callback = nullptr;
+	cp.my_cmd = false;
+	ServerNetworkGameSocketHandler::EncodeCommand(encoded.others, &cp);
+
+	if (owner != nullptr && owner->status >= NetworkClientSocket::STATUS_MAP) {
+		cp.callback = callback;
+		cp.my_cmd = true;
+		ServerNetworkGameSocketHandler::EncodeCommand(encoded.owner, &cp);
 	}
 
 	cp.callback = (nullptr != owner) ? nullptr : callback;
@@ -273,6 +289,21 @@ static void DistributeCommandPacket(CommandPacket &cp, const NetworkClientSocket
 	_local_execution_queue.Append(cp);
 }
 
+/**
+ * Make the encoded blocks immutable, so they can be shared between the queues of multiple clients.
+ * @param blocks The blocks to convert.
+ * @return The shared blocks.
+ */
+static std::vector<SharedPacketData> ShareCommandBlocks(std::vector<std::vector<byte>> &blocks)
+{
+	std::vector<SharedPacketData> shared;
+	shared.reserve(blocks.size());
+	for (std::vector<byte> &block : blocks) {
+		shared.push_back(std::make_shared<const std::vector<byte>>(std::move(block)));
+	}
+	return shared;
+}
+
 /**
  * "Send" a particular CommandQueue to all clients.
  * @param queue The queue of commands that has to be distributed.
@@ -287,11 +318,23 @@ static void DistributeQueue(CommandQueue *queue, const NetworkClientSocket *owne
 	int to_go = _settings_client.network.commands_per_frame;
 #endif
 
+	EncodedCommandBlocks encoded;
 	std::unique_ptr<CommandPacket> cp;
 	while (--to_go >= 0 && (cp = queue->Pop(true)) != nullptr) {
-		DistributeCommandPacket(*cp, owner);
+		DistributeCommandPacket(*cp, owner, encoded);
 		NetworkAdminCmdLogging(owner, cp.get());
 	}
+	if (encoded.others.empty()) return;
+
+	/* Queue the same encoded data for all clients, in the order the commands are executed in. */
+	const std::vector<SharedPacketData> owner_blocks = ShareCommandBlocks(encoded.owner);
+	const std::vector<SharedPacketData> other_blocks = ShareCommandBlocks(encoded.others);
+	for (NetworkClientSocket *cs : NetworkClientSocket::Iterate()) {
+		if (cs->status >= NetworkClientSocket::STATUS_MAP) {
+			const std::vector<SharedPacketData> &blocks = (cs == owner) ? owner_blocks : other_blocks;
+			cs->outgoing_commands.insert(cs->outgoing_commands.end(), blocks.begin(), blocks.end());
+		}
+	}
 }
 
 /** Distribute the commands of ourself and the clients. */
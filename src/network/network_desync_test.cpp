@@ -0,0 +1,385 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file network_desync_test.cpp Continuous desync self-test of a dedicated server.
+ *
+ * Every network.desync_test_interval ticks the game state is saved into memory,
+ * and the commands executed and the state checksums of every tick are recorded.
+ * At the end of such a window a forked copy of the server loads the saved state,
+ * exactly like a joining client would, replays the recorded commands and compares
+ * the checksums of every tick, followed by a full check of the caches.
+ * When anything differs, the saved state and the commands of the window are
+ * written to desync_test_*.sav and desync_test_*.log in the autosave directory.
+ */
+
+#include "../stdafx.h"
+#include "../debug.h"
+#include "../command_func.h"
+#include "../company_func.h"
+#include "../console_func.h"
+#include "../date_func.h"
+#include "../fileio_func.h"
+#include "../string_func.h"
+#include "../map_func.h"
+#include "../progress.h"
+#include "../settings_type.h"
+#include "../core/checksum_func.hpp"
+#include "../core/random_func.hpp"
+#include "../saveload/saveload.h"
+#include "../saveload/saveload_filter.h"
+#include "network.h"
+#include "network_internal.h"
+#include "network_server.h"
+#include "network_admin.h"
+#include "network_udp.h"
+#include "network_desync_test.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "../safeguards.h"
+
+bool _network_desync_test_replay = false; ///< Whether this is the copy of the server replaying a window of the desync self-test.
+
+#if defined(UNIX)
+
+extern void StateGameLoop();
+extern void CheckCaches(bool force_check, std::function<void(const char *)> log);
+
+/** Writing a savegame into a memory buffer. */
+struct DesyncTestSaveFilter : SaveFilter {
+	std::shared_ptr<std::vector<byte>> buffer; ///< The buffer to write to.
+
+	/**
+	 * Create the writer.
+	 * @param buffer The buffer to write to.
+	 */
+	DesyncTestSaveFilter(std::shared_ptr<std::vector<byte>> buffer) : SaveFilter(nullptr), buffer(std::move(buffer))
+	{
+	}
+
+	void Write(byte *buf, size_t size) override
+	{
+		this->buffer->insert(this->buffer->end(), buf, buf + size);
+	}
+};
+
+/** Reading a savegame from a memory buffer. */
+struct DesyncTestLoadFilter : LoadFilter {
+	std::shared_ptr<std::vector<byte>> buffer; ///< The buffer to read from.
+	size_t read_bytes = 0;                     ///< The number of bytes read so far.
+
+	/**
+	 * Create the reader.
+	 * @param buffer The buffer to read from.
+	 */
+	DesyncTestLoadFilter(std::shared_ptr<std::vector<byte>> buffer) : LoadFilter(nullptr), buffer(std::move(buffer))
+	{
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		size = std::min(size, this->buffer->size() - this->read_bytes);
+		memcpy(buf, this->buffer->data() + this->read_bytes, size);
+		this->read_bytes += size;
+		return size;
+	}
+
+	void Reset() override
+	{
+		this->read_bytes = 0;
+	}
+};
+
+/** A command executed during a window of the self-test. */
+struct DesyncTestCommand {
+	CommandPacket cp;        ///< The command, including the frame it was executed in.
+	Date date;               ///< Date the command was executed at.
+	DateFract date_fract;    ///< Date fraction the command was executed at.
+	uint8 tick_skip_counter; ///< Tick skip counter the command was executed at.
+};
+
+/** The state checksums after a tick. */
+struct DesyncTestTick {
+	uint32 random_state[2]; ///< State of the game's random generator.
+	uint64 state_checksum;  ///< The game state checksum.
+};
+
+/** A number of ticks of the game, starting with the state of the game before the first of them. */
+struct DesyncTestWindow {
+	std::shared_ptr<std::vector<byte>> savegame; ///< The game state at the start of the window.
+	uint32 start_frame;                          ///< The last frame before the window.
+	uint64 start_state_checksum;                 ///< The game state checksum at the start of the window.
+	std::vector<DesyncTestCommand> commands;     ///< The commands executed in the window, in order of execution.
+	std::vector<DesyncTestTick> ticks;           ///< The checksums after every tick of the window.
+	std::chrono::steady_clock::time_point start_time; ///< Real time the recording of the window started.
+};
+
+static std::unique_ptr<DesyncTestWindow> _desync_test_window;   ///< The window being recorded.
+static std::unique_ptr<DesyncTestWindow> _desync_test_checking; ///< The window being replayed.
+static pid_t _desync_test_pid = -1;                             ///< The copy of the server replaying #_desync_test_checking.
+static std::chrono::steady_clock::time_point _desync_test_deadline; ///< Real time by which the replay has to be finished.
+
+static const std::chrono::seconds DESYNC_TEST_MIN_TIMEOUT(60); ///< Minimum real time a replay may take before it is considered to be hung.
+
+/**
+ * Write the state and the commands of a window which failed the self-test.
+ * @param window The window.
+ * @param reason Why the window failed.
+ */
+static void WriteDesyncTestReport(const DesyncTestWindow &window, const std::string &reason)
+{
+	char name[MAX_PATH];
+	seprintf(name, lastof(name), "desync_test_%08x_%08x.sav", _settings_game.game_creation.generation_seed, window.start_frame);
+	FILE *f = FioFOpenFile(name, "wb", AUTOSAVE_DIR);
+	if (f != nullptr) {
+		fwrite(window.savegame->data(), 1, window.savegame->size(), f);
+		fclose(f);
+	}
+
+	seprintf(name, lastof(name), "desync_test_%08x_%08x.log", _settings_game.game_creation.generation_seed, window.start_frame);
+	f = FioFOpenFile(name, "w", AUTOSAVE_DIR);
+	if (f == nullptr) return;
+
+	fprintf(f, "Desync self-test of frames %u to %u failed:\n%s\n", window.start_frame + 1, window.start_frame + (uint)window.ticks.size(), reason.c_str());
+	for (const DesyncTestCommand &c : window.commands) {
+		const CommandPacket &cp = c.cp;
+		fprintf(f, "cmd: date{%08x; %02x; %02x}; company: %02x; tile: %06x (%u x %u); p1: %08x; p2: %08x; p3: " OTTD_PRINTFHEX64PAD "; cmd: %08x; \"%s\" %X (%s)\n",
+				c.date, c.date_fract, c.tick_skip_counter, (int)cp.company, cp.tile, TileX(cp.tile), TileY(cp.tile), cp.p1, cp.p2, cp.p3,
+				cp.cmd & ~CMD_NETWORK_COMMAND, cp.text.c_str(), cp.binary_length, GetCommandName(cp.cmd));
+	}
+	fclose(f);
+}
+
+/**
+ * Detach this copy of the server from the network of the server, and make it a joining client.
+ * The inherited sockets are closed without sending anything, so the connections of the server are
+ * not kept open by the copy, and the game state is loaded the way a joining client loads it.
+ */
+static void DetachDesyncTestReplayFromNetwork()
+{
+	for (NetworkClientSocket *cs : NetworkClientSocket::Iterate()) {
+		if (cs->sock != INVALID_SOCKET) closesocket(cs->sock);
+		cs->sock = INVALID_SOCKET;
+	}
+	for (ServerNetworkAdminSocketHandler *as : ServerNetworkAdminSocketHandler::Iterate()) {
+		if (as->sock != INVALID_SOCKET) closesocket(as->sock);
+		as->sock = INVALID_SOCKET;
+	}
+	ServerNetworkGameSocketHandler::CloseListeners();
+	ServerNetworkAdminSocketHandler::CloseListeners();
+	NetworkUDPClose();
+
+	_networking = true;
+	_network_server = false;
+}
+
+/**
+ * Replay a window in this copy of the server and exit.
+ * The exit status is 0 when the window passed the self-test, and 1 when it failed.
+ * @param window The window to replay.
+ */
+static void ReplayDesyncTestWindow(const DesyncTestWindow &window)
+{
+	_network_desync_test_replay = true;
+
+	/* Nothing of the copy should end up in the log of the server. */
+	int null_fd = open("/dev/null", O_WRONLY);
+	if (null_fd != -1) {
+		dup2(null_fd, fileno(stdout));
+		dup2(null_fd, fileno(stderr));
+		close(null_fd);
+	}
+
+	DetachDesyncTestReplayFromNetwork();
+
+	if (LoadWithFilter(new DesyncTestLoadFilter(window.savegame)) != SL_OK) {
+		WriteDesyncTestReport(window, "Loading the game state failed");
+		_exit(1);
+	}
+
+	_state_checksum.state = window.start_state_checksum;
+	_frame_counter = window.start_frame;
+
+	auto command = window.commands.begin();
+	for (const DesyncTestTick &tick : window.ticks) {
+		_frame_counter++;
+		for (; command != window.commands.end() && command->cp.frame == _frame_counter; ++command) {
+			CommandPacket cp = command->cp;
+			_current_company = cp.company;
+			DoCommandP(&cp, false);
+		}
+		_current_company = _local_company;
+
+		StateGameLoop();
+
+		if (_random.state[0] != tick.random_state[0] || _random.state[1] != tick.random_state[1] || _state_checksum.state != tick.state_checksum) {
+			WriteDesyncTestReport(window, stdstr_fmt("Frame %u differs: random %08x %08x, state " OTTD_PRINTFHEX64PAD " instead of random %08x %08x, state " OTTD_PRINTFHEX64PAD,
+					_frame_counter, _random.state[0], _random.state[1], _state_checksum.state, tick.random_state[0], tick.random_state[1], tick.state_checksum));
+			_exit(1);
+		}
+	}
+
+	std::string cache_log;
+	CheckCaches(true, [&](const char *str) {
+		cache_log += str;
+		cache_log += '\n';
+	});
+	if (!cache_log.empty()) {
+		WriteDesyncTestReport(window, "Cache check failed:\n" + cache_log);
+		_exit(1);
+	}
+
+	_exit(0);
+}
+
+/** Check whether the copy of the server replaying a window has finished, and report its result. */
+static void ReapDesyncTestCheck()
+{
+	if (_desync_test_pid == -1) return;
+
+	const DesyncTestWindow &window = *_desync_test_checking;
+	uint first = window.start_frame + 1;
+	uint last = window.start_frame + (uint)window.ticks.size();
+
+	int status;
+	if (waitpid(_desync_test_pid, &status, WNOHANG) != _desync_test_pid) {
+		if (std::chrono::steady_clock::now() < _desync_test_deadline) return;
+
+		/* A hung replay would block the self-test of all later windows. */
+		kill(_desync_test_pid, SIGKILL);
+		waitpid(_desync_test_pid, &status, 0);
+		_desync_test_pid = -1;
+		WriteDesyncTestReport(window, "Replaying the window timed out");
+		IConsolePrintF(CC_ERROR, "Desync self-test of frames %u to %u timed out, see desync_test_%08x_%08x.sav/.log in the autosave directory",
+				first, last, _settings_game.game_creation.generation_seed, window.start_frame);
+		_desync_test_checking.reset();
+		return;
+	}
+	_desync_test_pid = -1;
+
+	if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+		DEBUG(desync, 2, "Desync self-test of frames %u to %u passed", first, last);
+	} else if (WIFEXITED(status)) {
+		IConsolePrintF(CC_ERROR, "Desync self-test of frames %u to %u failed, see desync_test_%08x_%08x.sav/.log in the autosave directory",
+				first, last, _settings_game.game_creation.generation_seed, window.start_frame);
+	} else {
+		WriteDesyncTestReport(window, stdstr_fmt("Replaying the window crashed with signal %d", WIFSIGNALED(status) ? WTERMSIG(status) : 0));
+		IConsolePrintF(CC_ERROR, "Desync self-test of frames %u to %u crashed, see desync_test_%08x_%08x.sav/.log in the autosave directory",
+				first, last, _settings_game.game_creation.generation_seed, window.start_frame);
+	}
+	_desync_test_checking.reset();
+}
+
+/**
+ * Record a command executed by the server for the window being recorded.
+ * @param cp The command, as it is going to be executed.
+ */
+void NetworkDesyncTestRecordCommand(const CommandPacket *cp)
+{
+	if (_desync_test_window == nullptr) return;
+
+	_desync_test_window->commands.push_back({ *cp, _date, _date_fract, _tick_skip_counter });
+	_desync_test_window->commands.back().cp.next = nullptr;
+}
+
+/**
+ * Record the tick the server has just run, and replay the window when it is complete.
+ * Called by the server after every tick.
+ */
+void NetworkDesyncTestTick()
+{
+	ReapDesyncTestCheck();
+
+	if (_settings_client.network.desync_test_interval == 0 || !_network_dedicated || HasModalProgress()) {
+		_desync_test_window.reset();
+		return;
+	}
+
+	if (_desync_test_window != nullptr) {
+		_desync_test_window->ticks.push_back({ { _random.state[0], _random.state[1] }, _state_checksum.state });
+		if (_desync_test_window->ticks.size() < _settings_client.network.desync_test_interval) return;
+
+		if (_desync_test_pid != -1) {
+			/* Only one window is replayed at a time; rather skip one than let the server fall behind. */
+			DEBUG(desync, 1, "Desync self-test of frames %u to %u skipped, the previous one is still running",
+					_desync_test_window->start_frame + 1, _frame_counter);
+		} else {
+			_desync_test_checking = std::move(_desync_test_window);
+
+			/* The replay has no time to wait for, so it should be well within the real time the window took. */
+			const auto window_time = std::chrono::steady_clock::now() - _desync_test_checking->start_time;
+			_desync_test_deadline = std::chrono::steady_clock::now() + std::max<std::chrono::steady_clock::duration>(DESYNC_TEST_MIN_TIMEOUT, 2 * window_time);
+
+			pid_t pid = fork();
+			if (pid == 0) ReplayDesyncTestWindow(*_desync_test_checking);
+			if (pid == -1) {
+				DEBUG(desync, 0, "Desync self-test: unable to fork: %s", strerror(errno));
+				_desync_test_checking.reset();
+			}
+			_desync_test_pid = pid;
+		}
+	}
+
+	/* Start the next window with the current game state. */
+	WaitTillSaved();
+	std::unique_ptr<DesyncTestWindow> window(new DesyncTestWindow());
+	window->savegame = std::make_shared<std::vector<byte>>();
+	if (SaveWithFilter(new DesyncTestSaveFilter(window->savegame), false, SMF_NONE) != SL_OK) {
+		DEBUG(desync, 0, "Desync self-test: saving the game state failed");
+		_desync_test_window.reset();
+		return;
+	}
+	window->start_frame = _frame_counter;
+	window->start_state_checksum = _state_checksum.state;
+	window->start_time = std::chrono::steady_clock::now();
+	_desync_test_window = std::move(window);
+}
+
+/** Stop recording the current window and replaying the previous one, as the game they belong to is gone. */
+void NetworkDesyncTestReset()
+{
+	_desync_test_window.reset();
+
+	if (_desync_test_pid != -1) {
+		kill(_desync_test_pid, SIGKILL);
+		waitpid(_desync_test_pid, nullptr, 0);
+		_desync_test_pid = -1;
+	}
+	_desync_test_checking.reset();
+}
+
+#else
+
+void NetworkDesyncTestRecordCommand(const CommandPacket *cp) {}
+
+/** The self-test needs to fork the server, so it is not available here. */
+void NetworkDesyncTestTick()
+{
+	static bool warned = false;
+	if (_settings_client.network.desync_test_interval != 0 && !warned) {
+		DEBUG(desync, 0, "Desync self-test is not supported on this platform");
+		warned = true;
+	}
+}
+
+void NetworkDesyncTestReset() {}
+
+#endif /* UNIX */
@@ -0,0 +1,21 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file network_desync_test.h Continuous desync self-test of a dedicated server. */
+
+#ifndef NETWORK_DESYNC_TEST_H
+#define NETWORK_DESYNC_TEST_H
+
+struct CommandPacket;
+
+extern bool _network_desync_test_replay;
+
+void NetworkDesyncTestRecordCommand(const CommandPacket *cp);
+void NetworkDesyncTestTick();
+void NetworkDesyncTestReset();
+
+#endif /* NETWORK_DESYNC_TEST_H */
@@ -57,6 +57,43 @@ INSTANTIATE_POOL_METHODS(NetworkClientSocket)
 /** Instantiate the listen sockets. */
 template SocketList TCPListenHandler<ServerNetworkGameSocketHandler, PACKET_SERVER_FULL, PACKET_SERVER_BANNED>::sockets;
 
+/** State hash trees of the most recent sync frames, when network.desync_state_hash is enabled. */
+static StateHashTree _sync_state_hash_trees[4];
+/** Index in #_sync_state_hash_trees to store the next tree at. */
+static uint _sync_state_hash_tree_next = 0;
+
+/**
+ * Find the state hash tree we computed at a sync frame.
+ * @param frame The frame.
+ * @return The tree, or nullptr if we have none for the frame.
+ */
+static const StateHashTree *FindSyncStateHashTree(uint32 frame)
+{
+	for (const StateHashTree &tree : _sync_state_hash_trees) {
+		if (tree.root != 0 && tree.frame == frame) return &tree;
+	}
+	return nullptr;
+}
+
+/**
+ * Compare a state hash tree received from a client with the one we computed at the same frame.
+ * @param theirs The tree received from the client.
+ * @return Description of the differences.
+ */
+static std::string NetworkCompareDesyncStateHash(const StateHashTree &theirs)
+{
+	const StateHashTree *ours = FindSyncStateHashTree(theirs.frame);
+	if (ours != nullptr) return CompareStateHashTrees(*ours, theirs);
+	return stdstr_fmt("No server state hash tree available for frame %u\n", theirs.frame);
+}
+
+/** Forget the state hash trees of the sync frames, when a new game is started. */
+void NetworkServerResetSyncStateHashTrees()
+{
+	for (StateHashTree &tree : _sync_state_hash_trees) tree = StateHashTree();
+	_sync_state_hash_tree_next = 0;
+}
+
 /** Writing a savegame directly to a number of packets. */
 struct PacketWriter : SaveFilter {
 	ServerNetworkGameSocketHandler *cs; ///< Socket we are associated with.
@@ -139,6 +176,13 @@ struct PacketWriter : SaveFilter {
 		return last_packet;
 	}
 
+	/** Start a new map data packet, with its buffer reserved up front. */
+	void NewDataPacket()
+	{
+		this->current.reset(new Packet(PACKET_SERVER_MAP_DATA, SHRT_MAX));
+		this->current->ReserveBuffer(SHRT_MAX);
+	}
+
 	/** Append the current packet to the queue. */
 	void AppendQueue()
 	{
@@ -152,7 +196,7 @@ struct PacketWriter : SaveFilter {
 		/* We want to abort the saving when the socket is closed. */
 		if (this->cs == nullptr) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
 
-		if (this->current == nullptr) this->current.reset(new Packet(PACKET_SERVER_MAP_DATA, SHRT_MAX));
+		if (this->current == nullptr) this->NewDataPacket();
 
 		std::lock_guard<std::mutex> lock(this->mutex);
 
@@ -163,7 +207,7 @@ struct PacketWriter : SaveFilter {
 
 			if (!this->current->CanWriteToPacket(1)) {
 				this->AppendQueue();
-				if (buf != bufe) this->current.reset(new Packet(PACKET_SERVER_MAP_DATA, SHRT_MAX));
+				if (buf != bufe) this->NewDataPacket();
 			}
 		}
 
@@ -200,6 +244,7 @@ ServerNetworkGameSocketHandler::ServerNetworkGameSocketHandler(SOCKET s) : Netwo
 	this->status = STATUS_INACTIVE;
 	this->client_id = _network_client_id++;
 	this->receive_limit = _settings_client.network.bytes_per_frame_burst;
+	this->desync_state_hash_requested = false;
 	this->server_hash_bits = InteractiveRandom();
 	this->rcon_hash_bits = InteractiveRandom();
 	this->settings_hash_bits = InteractiveRandom();
@@ -714,19 +759,23 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendSync()
 }
 
 /**
- * Send a command to the client to execute.
- * @param cp The command to send.
+ * Encode a command for clients to execute, as a complete PACKET_SERVER_COMMAND packet.
+ * The packet is appended to the last block, or to a new block if the last one would become too large
+ * to send as one shared packet. The blocks can be queued on any number of client sockets.
+ * @param blocks The blocks of encoded packets to append to.
+ * @param cp The command to encode.
  */
-NetworkRecvStatus ServerNetworkGameSocketHandler::SendCommand(const CommandPacket *cp)
+/* static */ void ServerNetworkGameSocketHandler::EncodeCommand(std::vector<std::vector<byte>> &blocks, const CommandPacket *cp)
 {
-	Packet *p = new Packet(PACKET_SERVER_COMMAND, SHRT_MAX);
+	Packet p(PACKET_SERVER_COMMAND, SHRT_MAX);
 
-	this->NetworkGameSocketHandler::SendCommand(p, cp);
-	p->Send_uint32(cp->frame);
-	p->Send_bool  (cp->my_cmd);
+	NetworkGameSocketHandler::SendCommand(&p, cp);
+	p.Send_uint32(cp->frame);
+	p.Send_bool  (cp->my_cmd);
+	p.PrepareToSend();
 
-	this->SendPacket(p);
-	return NETWORK_RECV_STATUS_OKAY;
+	if (blocks.empty() || blocks.back().size() + p.Size() > SHRT_MAX) blocks.emplace_back();
+	blocks.back().insert(blocks.back().end(), p.GetBufferData(), p.GetBufferData() + p.Size());
 }
 
 /**
@@ -839,13 +888,15 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendCompanyUpdate()
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
-/** Send an update about the max company/spectator counts. */
+/** Send an update about the max company/spectator counts, and whether we want the state hash tree after a desync. */
 NetworkRecvStatus ServerNetworkGameSocketHandler::SendConfigUpdate()
 {
 	Packet *p = new Packet(PACKET_SERVER_CONFIG_UPDATE, SHRT_MAX);
 
 	p->Send_uint8(_settings_client.network.max_companies);
 	p->Send_uint8(_settings_client.network.max_spectators);
+	p->Send_bool(_settings_client.network.desync_state_hash);
+	this->desync_state_hash_requested = _settings_client.network.desync_state_hash;
 	this->SendPacket(p);
 	return NETWORK_RECV_STATUS_OKAY;
 }
@@ -1212,8 +1263,16 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_ERROR(Packet *p
 	NetworkAdminClientError(this->client_id, errorno);
 
 	if (errorno == NETWORK_ERROR_DESYNC) {
+		DesyncExtraInfo info;
+		std::string state_hash_report;
+		if (this->desync_state_hash != nullptr) {
+			state_hash_report = NetworkCompareDesyncStateHash(*(this->desync_state_hash));
+			info.state_hash_report = &state_hash_report;
+			DEBUG(desync, 0, "Client-id %d state hash comparison:\n%s", this->client_id, state_hash_report.c_str());
+		}
+
 		std::string server_desync_log;
-		CrashLog::DesyncCrashLog(&(this->desync_log), &server_desync_log, DesyncExtraInfo{});
+		CrashLog::DesyncCrashLog(&(this->desync_log), &server_desync_log, info);
 		this->SendDesyncLog(server_desync_log);
 
 		// decrease the sync frequency for this point onwards
@@ -1241,6 +1300,50 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_DESYNC_LOG(Pack
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_DESYNC_STATE_HASH(Packet *p)
+{
+	/* Only clients in the game which we asked for their tree may send it. */
+	if (!this->desync_state_hash_requested || this->status < STATUS_DONE_MAP || this->status > STATUS_ACTIVE) return this->SendError(NETWORK_ERROR_NOT_EXPECTED);
+
+	uint8 type = p->Recv_uint8();
+	if (type == 0) {
+		this->desync_state_hash.reset(new StateHashTree());
+		StateHashTree &tree = *(this->desync_state_hash);
+		tree.frame = p->Recv_uint32();
+		tree.date = p->Recv_uint32();
+		tree.date_fract = p->Recv_uint16();
+		tree.tick_skip_counter = p->Recv_uint8();
+		tree.root = p->Recv_uint64();
+		for (uint i = 0; i < SHS_END; i++) {
+			tree.subsystems[i] = p->Recv_uint64();
+		}
+		DEBUG(net, 2, "Received state hash tree header for frame %u from client %d", tree.frame, this->client_id);
+		return NETWORK_RECV_STATUS_OKAY;
+	}
+
+	uint8 subsystem = p->Recv_uint8();
+	if (type != 1 || subsystem >= SHS_END || this->desync_state_hash == nullptr) return this->SendError(NETWORK_ERROR_NOT_EXPECTED);
+
+	uint16 count = p->Recv_uint16();
+
+	/* Without our tree of that frame there is nothing to compare the leaves with. */
+	const StateHashTree *ours = FindSyncStateHashTree(this->desync_state_hash->frame);
+	if (ours == nullptr) return NETWORK_RECV_STATUS_OKAY;
+
+	/* The client cannot have more leaves than we do, and the comparison requires them to be sorted by ID. */
+	std::vector<StateHashTree::Leaf> &leaves = this->desync_state_hash->leaves[subsystem];
+	if (leaves.size() + count > ours->leaves[subsystem].size()) return this->SendError(NETWORK_ERROR_NOT_EXPECTED);
+	leaves.reserve(leaves.size() + count);
+	for (uint i = 0; i < count; i++) {
+		StateHashTree::Leaf leaf;
+		leaf.id = p->Recv_uint32();
+		leaf.hash = p->Recv_uint64();
+		if (!leaves.empty() && leaf.id <= leaves.back().id) return this->SendError(NETWORK_ERROR_NOT_EXPECTED);
+		leaves.push_back(leaf);
+	}
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_DESYNC_MSG(Packet *p)
 {
 	Date date = p->Recv_uint32();
@@ -1280,6 +1383,25 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_QUIT(Packet *p)
 	return this->CloseConnection(NETWORK_RECV_STATUS_CONN_LOST);
 }
 
+/**
+ * Update the lag history of the client with an acknowledged frame, and derive how many
+ * ticks worth of frames and commands to bundle for it. A client which is far behind
+ * anyway hardly notices a few more ticks of delay, but saves a packet for every tick.
+ * @param frame The frame the client acknowledged.
+ */
+void ServerNetworkGameSocketHandler::UpdateFrameBatch(uint32 frame)
+{
+	/* Leave out the delay caused by the bundling itself, otherwise the bundles would only ever grow. */
+	uint sample = _frame_counter - frame;
+	sample = std::min<uint>(sample > this->frame_batch - 1u ? sample - (this->frame_batch - 1u) : 0, UINT16_MAX);
+
+	/* Exponential moving average, with a weight of 1/8 for the new sample. */
+	this->ack_lag = (this->ack_lag * 7 + sample * 16) / 8;
+
+	/* Bundle a quarter of the lag, so the client gets its frames at least four times per round trip. */
+	this->frame_batch = Clamp<uint>(this->ack_lag / (16 * 4), 1, _settings_client.network.max_frame_batch);
+}
+
 NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_ACK(Packet *p)
 {
 	if (this->status < STATUS_AUTHORIZED) {
@@ -1318,6 +1440,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_ACK(Packet *p)
 		this->last_token = 0;
 	}
 
+	if (this->status == STATUS_ACTIVE) this->UpdateFrameBatch(frame);
+
 	/* The client received the frame, make note of it */
 	this->last_frame = frame;
 	/* With those 2 values we can calculate the lag realtime */
@@ -1904,10 +2028,10 @@ void NetworkServerSetCompanyPassword(CompanyID company_id, const char *password,
  */
 static void NetworkHandleCommandQueue(NetworkClientSocket *cs)
 {
-	std::unique_ptr<CommandPacket> cp;
-	while ((cp = cs->outgoing_queue.Pop()) != nullptr) {
-		cs->SendCommand(cp.get());
+	for (SharedPacketData &data : cs->outgoing_commands) {
+		cs->SendPacket(std::unique_ptr<Packet>(new Packet(std::move(data))));
 	}
+	cs->outgoing_commands.clear();
 }
 
 /**
@@ -1924,6 +2048,11 @@ void NetworkServer_Tick(bool send_frame)
 	if (_frame_counter >= _last_sync_frame + _settings_client.network.sync_freq) {
 		_last_sync_frame = _frame_counter;
 		send_sync = true;
+
+		if (_settings_client.network.desync_state_hash) {
+			_sync_state_hash_trees[_sync_state_hash_tree_next].Compute(_frame_counter);
+			_sync_state_hash_tree_next = (_sync_state_hash_tree_next + 1) % lengthof(_sync_state_hash_trees);
+		}
 	}
 #endif
 
@@ -1957,7 +2086,11 @@ void NetworkServer_Tick(bool send_frame)
 				 * slow, but the connection is likely severed. Mentioning
 				 * frame_freq is not useful in this case. */
 				if (lag > (uint)DAY_TICKS && cs->lag_test == 0 && cs->last_packet + std::chrono::seconds(2) > std::chrono::steady_clock::now()) {
-					IConsolePrintF(CC_WARNING, "[%d] Client #%d is slow, try increasing [network.]frame_freq to a higher value!", _frame_counter, cs->client_id);
+					if (cs->frame_batch > 1) {
+						IConsolePrintF(CC_WARNING, "[%d] Client #%d is slow, frames are already bundled per %d ticks", _frame_counter, cs->client_id, cs->frame_batch);
+					} else {
+						IConsolePrintF(CC_WARNING, "[%d] Client #%d is slow, try increasing [network.]frame_freq to a higher value!", _frame_counter, cs->client_id);
+					}
 					cs->lag_test = 1;
 				}
 
@@ -2036,11 +2169,22 @@ void NetworkServer_Tick(bool send_frame)
 		}
 
 		if (cs->status >= NetworkClientSocket::STATUS_PRE_ACTIVE && cs->status != NetworkClientSocket::STATUS_CLOSE_PENDING) {
-			/* Check if we can send command, and if we have anything in the queue */
-			NetworkHandleCommandQueue(cs);
-
-			/* Send an updated _frame_counter_max to the client */
-			if (send_frame) cs->SendFrame();
+			/* Clients with a high latency get their frames and commands bundled. Commands are
+			 * always for frames beyond the last frame sent, so holding them back is safe. */
+			if (send_frame) cs->frame_pending = true;
+			uint batch = cs->status == NetworkClientSocket::STATUS_ACTIVE ? std::min<uint>(cs->frame_batch, _settings_client.network.max_frame_batch) : 1;
+			if (_frame_counter - cs->last_batch_frame >= batch) {
+				cs->last_batch_frame = _frame_counter;
+
+				/* Check if we can send command, and if we have anything in the queue */
+				NetworkHandleCommandQueue(cs);
+
+				/* Send an updated _frame_counter_max to the client */
+				if (cs->frame_pending) {
+					cs->frame_pending = false;
+					cs->SendFrame();
+				}
+			}
 
 #ifndef ENABLE_NETWORK_SYNC_EVERY_FRAME
 			/* Send a sync-check packet */
@@ -12,6 +12,8 @@
 
 #include "network_internal.h"
 #include "core/tcp_listen.h"
+#include "../state_hash.h"
+#include <memory>
 
 class ServerNetworkGameSocketHandler;
 /** Make the code look slightly nicer/simpler. */
@@ -39,6 +41,7 @@ protected:
 	NetworkRecvStatus Receive_CLIENT_ERROR(Packet *p) override;
 	NetworkRecvStatus Receive_CLIENT_DESYNC_LOG(Packet *p) override;
 	NetworkRecvStatus Receive_CLIENT_DESYNC_MSG(Packet *p) override;
+	NetworkRecvStatus Receive_CLIENT_DESYNC_STATE_HASH(Packet *p) override;
 	NetworkRecvStatus Receive_CLIENT_RCON(Packet *p) override;
 	NetworkRecvStatus Receive_CLIENT_NEWGRFS_CHECKED(Packet *p) override;
 	NetworkRecvStatus Receive_CLIENT_MOVE(Packet *p) override;
@@ -71,8 +74,12 @@ public:
 	byte lag_test;               ///< Byte used for lag-testing the client
 	byte last_token;             ///< The last random token we did send to verify the client is listening
 	uint32 last_token_frame;     ///< The last frame we received the right token
+	uint32 ack_lag = 0;          ///< Smoothed number of ticks the acknowledged frames lag behind, in 1/16 ticks
+	uint8 frame_batch = 1;       ///< Number of ticks worth of frames and commands bundled for this client
+	uint32 last_batch_frame = 0; ///< The frame at which the last bundle was sent
+	bool frame_pending = false;  ///< Whether a frame is waiting to be sent with the next bundle
 	ClientStatus status;         ///< Status of this client
-	CommandQueue outgoing_queue; ///< The command-queue awaiting delivery
+	std::vector<SharedPacketData> outgoing_commands; ///< Encoded command packets awaiting delivery
 	size_t receive_limit;        ///< Amount of bytes that we can receive at this moment
 	uint32 server_hash_bits;     ///< Server password hash entropy bits
 	uint32 rcon_hash_bits;       ///< Rcon password hash entropy bits
@@ -84,6 +91,8 @@ public:
 	NetworkAddress client_address; ///< IP-address of the client (so they can be banned)
 
 	std::string desync_log;
+	std::unique_ptr<StateHashTree> desync_state_hash; ///< State hash tree reported by the client after a desync
+	bool desync_state_hash_requested; ///< Whether we asked the client to send its state hash tree after a desync
 
 	ServerNetworkGameSocketHandler(SOCKET s);
 	~ServerNetworkGameSocketHandler();
@@ -109,8 +118,9 @@ public:
 	NetworkRecvStatus SendChat(NetworkAction action, ClientID client_id, bool self_send, const char *msg, NetworkTextMessageData data);
 	NetworkRecvStatus SendJoin(ClientID client_id);
 	NetworkRecvStatus SendFrame();
+	void UpdateFrameBatch(uint32 frame);
 	NetworkRecvStatus SendSync();
-	NetworkRecvStatus SendCommand(const CommandPacket *cp);
+	static void EncodeCommand(std::vector<std::vector<byte>> &blocks, const CommandPacket *cp);
 	NetworkRecvStatus SendCompanyUpdate();
 	NetworkRecvStatus SendConfigUpdate();
 	NetworkRecvStatus SendSettingsAccessUpdate(bool ok);
@@ -136,6 +146,7 @@ public:
 };
 
 void NetworkServer_Tick(bool send_frame);
+void NetworkServerResetSyncStateHashTrees();
 void NetworkServerSetCompanyPassword(CompanyID company_id, const char *password, bool already_hashed = true);
 void NetworkServerUpdateCompanyPassworded(CompanyID company_id, bool passworded);
 
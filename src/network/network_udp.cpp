@@ -33,6 +33,7 @@
 #endif
 
 #include "core/udp.h"
+#include "core/resolver.h"
 
 #include <vector>
 
@@ -123,6 +124,14 @@ static void DoNetworkUDPQueryServer(NetworkAddress &address, bool needs_mutex, b
 	if (_udp_client.socket != nullptr) _udp_client.socket->SendPacket(&p, &address);
 }
 
+/** Query of a server waiting for its address to be resolved. */
+struct PendingUDPQuery {
+	std::shared_ptr<NetworkResolveRequest> resolve; ///< The request resolving the address of the server.
+	bool manually;                                  ///< Whether the address was entered manually.
+};
+
+static std::vector<PendingUDPQuery> _udp_pending_queries; ///< Queries waiting for the address of the server to be resolved.
+
 /**
  * Query a specific server.
  * @param address The address of the server.
@@ -130,8 +139,27 @@ static void DoNetworkUDPQueryServer(NetworkAddress &address, bool needs_mutex, b
  */
 void NetworkUDPQueryServer(NetworkAddress address, bool manually)
 {
-	if (address.IsResolved() || !StartNewThread(nullptr, "ottd:udp-query", &DoNetworkUDPQueryServer, std::move(address), true, std::move(manually))) {
+	if (address.IsResolved()) {
 		DoNetworkUDPQueryServer(address, true, manually);
+		return;
+	}
+
+	/* Resolving may take a while, so send the query once the address is known. */
+	std::shared_ptr<NetworkResolveRequest> resolve = std::make_shared<NetworkResolveRequest>(address, SOCK_DGRAM);
+	_udp_pending_queries.push_back({ resolve, manually });
+	NetworkResolveAsync(std::move(resolve));
+}
+
+/** Send the queries of which the address of the server has been resolved. */
+static void NetworkUDPSendPendingQueries()
+{
+	for (auto iter = _udp_pending_queries.begin(); iter != _udp_pending_queries.end(); /* nothing */) {
+		if (!iter->resolve->done) {
+			iter++;
+			continue;
+		}
+		DoNetworkUDPQueryServer(iter->resolve->address, true, iter->manually);
+		iter = _udp_pending_queries.erase(iter);
 	}
 }
 
@@ -764,6 +792,7 @@ void NetworkUDPClose()
 	_udp_client.Close();
 	_udp_server.Close();
 	_udp_master.Close();
+	_udp_pending_queries.clear();
 
 	_network_udp_server = false;
 	_network_udp_broadcast = 0;
@@ -780,4 +809,6 @@ void NetworkBackgroundUDPLoop()
 		_udp_client.ReceivePackets();
 		if (_network_udp_broadcast > 0) _network_udp_broadcast--;
 	}
+
+	NetworkUDPSendPendingQueries();
 }
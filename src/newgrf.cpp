@@ -5317,6 +5317,8 @@ static void NewSpriteGroup(ByteReader *buf)
 				}
 			}
 
+			OptimiseDeterministicSpriteGroup(group, _cur.grffile->va2_optimise_stats);
+
 			break;
 		}
 
@@ -241,6 +241,18 @@ enum NewSignalAction3ID {
 	NSA3ID_CUSTOM_SIGNALS       = 0,                          ///< Action 3 ID for custom signal sprites
 };
 
+/** Statistics of the load-time VarAction2 optimiser, accumulated per GRF. */
+struct VarAction2OptimiseStats {
+	uint32 groups;             ///< Number of deterministic sprite groups seen
+	uint32 adjusts;            ///< Number of adjusts before optimisation
+	uint32 adjusts_removed;    ///< Number of adjusts removed
+	uint32 constants_folded;   ///< Number of adjusts folded into a constant
+	uint32 noops_removed;      ///< Number of no-op adjusts removed
+	uint32 dead_adjusts;       ///< Number of adjusts removed because their result was discarded
+	uint32 dead_stores;        ///< Number of temporary storage stores removed because they were overwritten
+	uint32 jump_tables;        ///< Number of range lists converted to jump tables
+};
+
 /** Dynamic data of a loaded NewGRF */
 struct GRFFile : ZeroedMemoryAllocator {
 	char *filename;
@@ -296,6 +308,8 @@ struct GRFFile : ZeroedMemoryAllocator {
 	byte new_signal_ctrl_flags;              ///< Ctrl flags for new signals
 	byte new_signal_extra_aspects;           ///< Number of extra aspects for new signals
 
+	VarAction2OptimiseStats va2_optimise_stats; ///< Statistics of the VarAction2 load-time optimiser
+
 	GRFFile(const struct GRFConfig *config);
 	~GRFFile();
 
@@ -10,6 +10,7 @@
 #include "stdafx.h"
 #include "debug.h"
 #include "industry.h"
+#include "industry_kdtree.h"
 #include "newgrf_industries.h"
 #include "newgrf_town.h"
 #include "newgrf_cargo.h"
@@ -90,14 +91,12 @@ uint32 GetIndustryIDAtOffset(TileIndex tile, const Industry *i, uint32 cur_grfid
 
 static uint32 GetClosestIndustry(TileIndex tile, IndustryType type, const Industry *current)
 {
-	uint32 best_dist = UINT32_MAX;
-	for (const Industry *i : Industry::Iterate()) {
-		if (i->type != type || i == current) continue;
+	/* Skip the search when there is no industry of the type at all. */
+	if (Industry::GetIndustryTypeCount(type) == 0) return UINT32_MAX;
 
-		best_dist = std::min(best_dist, DistanceManhattan(tile, i->location.tile));
-	}
-
-	return best_dist;
+	return FindClosestIndustryDistance(tile, [&](const Industry *i) {
+		return i->type == type && i != current;
+	});
 }
 
 /**
@@ -141,7 +140,7 @@ static uint32 GetCountAndDistanceOfClosestInstance(byte param_setID, byte layout
 		 * In either case, just do the regular var67 */
 		closest_dist = GetClosestIndustry(current->location.tile, ind_index, current);
 		count = std::min<uint>(Industry::GetIndustryTypeCount(ind_index), UINT8_MAX); // clamp to 8 bit
-	} else {
+	} else if (Industry::GetIndustryTypeCount(ind_index) > 0) {
 		/* Count only those who match the same industry type and layout filter
 		 * Unfortunately, we have to do it manually */
 		for (const Industry *i : Industry::Iterate()) {
@@ -20,6 +20,7 @@
 
 std::vector<NewGRFProfiler> _newgrf_profilers;
 Date _newgrf_profile_end_date;
+NewGRFStackProfiler _newgrf_stack_profiler;
 
 
 /**
@@ -160,3 +161,150 @@ uint32 NewGRFProfiler::FinishAll()
 
 	return total_microseconds;
 }
+
+static uint64 GetStackProfilerNanoseconds()
+{
+	using namespace std::chrono;
+	return (uint64)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Capture the start of a sprite group resolution, if it is to be sampled.
+ * @param resolver  Data about sprite group being resolved
+ * @param group     Sprite group being resolved
+ * @param top_level Whether this is a top-level resolution
+ * @return true if the resolution is being sampled, and EndResolve must be called on completion.
+ */
+bool NewGRFStackProfiler::BeginResolve(const ResolverObject &resolver, const SpriteGroup *group, bool top_level)
+{
+	if (top_level) {
+		/* Nested top-level resolutions (e.g. a callback from within a callback) are not sampled separately */
+		if (this->sampling) return false;
+		if (++this->counter < this->interval) return false;
+		this->counter = 0;
+		this->sampling = true;
+		this->cur_stack.grffile = resolver.grffile;
+		this->cur_stack.feat = resolver.GetFeature();
+		this->cur_stack.cb = resolver.callback;
+		this->cur_stack.groups.clear();
+	} else if (!this->sampling) {
+		return false;
+	}
+
+	this->cur_stack.groups.push_back(group->nfo_line);
+	this->frames.push_back({ GetStackProfilerNanoseconds(), 0 });
+	return true;
+}
+
+/**
+ * Capture the completion of a sampled sprite group resolution.
+ */
+void NewGRFStackProfiler::EndResolve()
+{
+	const uint64 elapsed = GetStackProfilerNanoseconds() - this->frames.back().start;
+	this->totals[this->cur_stack] += elapsed - std::min(elapsed, this->frames.back().child_time);
+	this->frames.pop_back();
+	this->cur_stack.groups.pop_back();
+
+	if (this->frames.empty()) {
+		this->sampling = false;
+		this->samples++;
+	} else {
+		this->frames.back().child_time += elapsed;
+	}
+}
+
+void NewGRFStackProfiler::Start(uint32 interval)
+{
+	this->Abort();
+	this->interval = std::max<uint32>(interval, 1);
+	this->active = true;
+	this->start_tick = _scaled_tick_counter;
+}
+
+/**
+ * Stop profiling and write the collected data to a folded stack file.
+ * @return Estimated total resolution time, in microseconds.
+ */
+uint64 NewGRFStackProfiler::Finish()
+{
+	if (!this->active) return 0;
+
+	if (this->totals.empty()) {
+		IConsolePrint(CC_DEBUG, "Finished NewGRF stack profile, no samples collected, not writing a file");
+		this->Abort();
+		return 0;
+	}
+
+	std::string filename = this->GetOutputFilename();
+	IConsolePrintF(CC_DEBUG, "Finished NewGRF stack profile, writing " OTTD_PRINTF64U " samples (1 in %u) over %u ticks to %s",
+			this->samples, this->interval, _scaled_tick_counter - this->start_tick, filename.c_str());
+
+	FILE *f = FioFOpenFile(filename, "wt", Subdirectory::NO_DIRECTORY);
+	if (f == nullptr) {
+		IConsolePrintF(CC_ERROR, "Failed to open %s for writing", filename.c_str());
+		this->Abort();
+		return 0;
+	}
+	FileCloser fcloser(f);
+
+	/* One line per stack: semicolon separated frames, followed by the estimated self time in nanoseconds */
+	uint64 total_nanoseconds = 0;
+	for (const auto &it : this->totals) {
+		const Stack &stack = it.first;
+		const uint64 nanoseconds = it.second * this->interval;
+		if (stack.grffile != nullptr) {
+			const char *name = stack.grffile->filename;
+			const char *sep = strrchr(name, PATHSEPCHAR);
+			if (sep != nullptr) name = sep + 1;
+			fprintf(f, "[%08X] ", BSWAP32(stack.grffile->grfid));
+			for (const char *c = name; *c != '\0'; c++) {
+				fputc(*c == ';' ? '_' : *c, f);
+			}
+		} else {
+			fputs("[no GRF]", f);
+		}
+		fprintf(f, ";feature 0x%02X", stack.feat);
+		if (stack.cb == CBID_NO_CALLBACK) {
+			fputs(";sprite", f);
+		} else {
+			fprintf(f, ";callback 0x%X", (uint)stack.cb);
+		}
+		for (uint32 nfo_line : stack.groups) {
+			fprintf(f, ";group %u", nfo_line);
+		}
+		fprintf(f, " " OTTD_PRINTF64U "\n", nanoseconds);
+		total_nanoseconds += nanoseconds;
+	}
+
+	this->Abort();
+
+	return total_nanoseconds / 1000;
+}
+
+void NewGRFStackProfiler::Abort()
+{
+	this->active = false;
+	this->sampling = false;
+	this->counter = 0;
+	this->samples = 0;
+	this->frames.clear();
+	this->totals.clear();
+}
+
+/**
+ * Get name of the file that will be written.
+ * @return File name of folded stack output file.
+ */
+std::string NewGRFStackProfiler::GetOutputFilename() const
+{
+	time_t write_time = time(nullptr);
+
+	char timestamp[16] = {};
+	strftime(timestamp, lengthof(timestamp), "%Y%m%d-%H%M", localtime(&write_time));
+
+	char filepath[MAX_PATH] = {};
+	seprintf(filepath, lastof(filepath), "%sgrfstacks-%s.folded", FiosGetScreenshotDir(), timestamp);
+
+	return std::string(filepath);
+}
@@ -19,6 +19,8 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <map>
+#include <tuple>
 
 /**
  * Callback profiler for NewGRF development
@@ -60,4 +62,50 @@ struct NewGRFProfiler {
 extern std::vector<NewGRFProfiler> _newgrf_profilers;
 extern Date _newgrf_profile_end_date;
 
+/**
+ * Sampling profiler of sprite group resolution, covering all GRFs at once.
+ * Resolution time is attributed to the GRF, feature, callback and the chain of nested sprite groups,
+ * and is written out in the folded stack format used by flame graph tools.
+ */
+struct NewGRFStackProfiler {
+	/** Stack of a sampled resolution, used as the aggregation key */
+	struct Stack {
+		const GRFFile *grffile;      ///< GRF being resolved
+		GrfSpecFeature feat;         ///< GRF feature being resolved for
+		CallbackID cb;               ///< Callback ID
+		std::vector<uint32> groups;  ///< NFO lines of the nested sprite groups, outermost first
+
+		bool operator<(const Stack &other) const
+		{
+			return std::tie(this->grffile, this->feat, this->cb, this->groups) < std::tie(other.grffile, other.feat, other.cb, other.groups);
+		}
+	};
+
+	/** Sprite group resolution in progress */
+	struct Frame {
+		uint64 start;       ///< Start time (nanoseconds)
+		uint64 child_time;  ///< Time spent in nested resolutions (nanoseconds)
+	};
+
+	bool active = false;              ///< Is this profiler collecting data
+	bool sampling = false;            ///< Is the current top-level resolution being sampled
+	uint32 interval = 1;              ///< Sample one in this many top-level resolutions
+	uint32 counter = 0;               ///< Top-level resolutions since the last sample
+	uint64 samples = 0;               ///< Number of sampled top-level resolutions
+	uint32 start_tick = 0;            ///< Scaled tick counter value this profiler was started on
+	Stack cur_stack;                  ///< Stack of the current sampled resolution
+	std::vector<Frame> frames;        ///< Frames of the current sampled resolution
+	std::map<Stack, uint64> totals;   ///< Self time per stack (nanoseconds)
+
+	bool BeginResolve(const ResolverObject &resolver, const SpriteGroup *group, bool top_level);
+	void EndResolve();
+
+	void Start(uint32 interval);
+	uint64 Finish();
+	void Abort();
+	std::string GetOutputFilename() const;
+};
+
+extern NewGRFStackProfiler _newgrf_stack_profiler;
+
 #endif /* NEWGRF_PROFILING_H */
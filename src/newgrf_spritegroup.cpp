@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include "debug.h"
+#include "newgrf.h"
 #include "newgrf_spritegroup.h"
 #include "newgrf_profiling.h"
 #include "core/pool_func.hpp"
@@ -38,6 +39,24 @@ TemporaryStorageArray<int32, 0x110> _temp_store;
 {
 	if (group == nullptr) return nullptr;
 
+	if (unlikely(_newgrf_stack_profiler.active) && _newgrf_stack_profiler.BeginResolve(object, group, top_level)) {
+		const SpriteGroup *result = SpriteGroup::ResolveProfiled(group, object, top_level);
+		_newgrf_stack_profiler.EndResolve();
+		return result;
+	}
+
+	return SpriteGroup::ResolveProfiled(group, object, top_level);
+}
+
+/**
+ * Resolve a sprite group, and collect data for any active per-GRF profiler.
+ * @param group the group to resolve for, not nullptr
+ * @param object information needed to resolve the group
+ * @param top_level true if this is a top-level SpriteGroup, false if used nested in another SpriteGroup.
+ * @return the resolved group
+ */
+/* static */ const SpriteGroup *SpriteGroup::ResolveProfiled(const SpriteGroup *group, ResolverObject &object, bool top_level)
+{
 	const GRFFile *grf = object.grffile;
 	auto profiler = std::find_if(_newgrf_profilers.begin(), _newgrf_profilers.end(), [&](const NewGRFProfiler &pr) { return pr.grffile == grf; });
 
@@ -188,6 +207,211 @@ static bool RangeHighComparator(const DeterministicSpriteGroupRange& range, uint
 	return range.high < value;
 }
 
+static uint32 EvalAdjust(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust, ScopeResolver *scope, uint32 last_value, uint32 value)
+{
+	switch (size) {
+		case DSG_SIZE_BYTE:  return EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value);
+		case DSG_SIZE_WORD:  return EvalAdjustT<uint16, int16>(adjust, scope, last_value, value);
+		case DSG_SIZE_DWORD: return EvalAdjustT<uint32, int32>(adjust, scope, last_value, value);
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Is the variable of this adjust always available and free of side-effects?
+ * Adjusts reading any other variable can not be removed, as an unavailable variable diverts resolution to the error group.
+ * None of these variables read the temporary storage, except 0x7D.
+ */
+static bool IsVarAction2AdjustVariablePure(const DeterministicSpriteGroupAdjust &adjust)
+{
+	switch (adjust.variable) {
+		case 0x0C:
+		case 0x10:
+		case 0x18:
+		case 0x1A:
+		case 0x1C:
+		case 0x7D:
+		case 0x7F:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/** Is this adjust a constant, i.e. does it read variable 0x1A (always -1)? */
+static bool IsVarAction2AdjustConstant(const DeterministicSpriteGroupAdjust &adjust)
+{
+	return adjust.variable == 0x1A && (adjust.type == DSGA_TYPE_NONE || adjust.divmod_val != 0);
+}
+
+/** Is this adjust's operation free of side-effects, such that it only affects last_value? */
+static bool IsVarAction2AdjustOperationPure(const DeterministicSpriteGroupAdjust &adjust)
+{
+	return adjust.operation != DSGA_OP_STO && adjust.operation != DSGA_OP_STOP && adjust.operation < DSGA_OP_END;
+}
+
+/** Get the value of a constant adjust, after shift, mask and div/mod. */
+static uint32 GetVarAction2AdjustConstantValue(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust)
+{
+	DeterministicSpriteGroupAdjust rst = adjust;
+	rst.operation = DSGA_OP_RST;
+	return EvalAdjust(size, rst, nullptr, 0, UINT_MAX);
+}
+
+/** Is this constant adjust an identity operation on last_value? */
+static bool IsVarAction2AdjustNoOp(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust)
+{
+	const uint32 value = GetVarAction2AdjustConstantValue(size, adjust);
+	const uint32 size_mask = size == DSG_SIZE_BYTE ? 0xFF : (size == DSG_SIZE_WORD ? 0xFFFF : 0xFFFFFFFF);
+	switch (adjust.operation) {
+		case DSGA_OP_ADD:
+		case DSGA_OP_SUB:
+		case DSGA_OP_OR:
+		case DSGA_OP_XOR:
+		case DSGA_OP_SMOD:
+		case DSGA_OP_UMOD:
+			return value == 0;
+
+		case DSGA_OP_ROR:
+		case DSGA_OP_SHL:
+		case DSGA_OP_SHR:
+		case DSGA_OP_SAR:
+			return (value & 0x1F) == 0;
+
+		case DSGA_OP_SDIV:
+		case DSGA_OP_UDIV:
+			return value == 0 || (value & size_mask) == 1;
+
+		case DSGA_OP_MUL:
+			return (value & size_mask) == 1;
+
+		case DSGA_OP_AND:
+			return (value & size_mask) == size_mask;
+
+		default:
+			return false;
+	}
+}
+
+/** Make a constant adjust which returns \a value. */
+static DeterministicSpriteGroupAdjust MakeVarAction2ConstantAdjust(uint32 value)
+{
+	DeterministicSpriteGroupAdjust adjust{};
+	adjust.operation = DSGA_OP_RST;
+	adjust.type = DSGA_TYPE_NONE;
+	adjust.variable = 0x1A;
+	adjust.and_mask = value;
+	return adjust;
+}
+
+/**
+ * Load-time optimiser for the adjusts and ranges of a deterministic sprite group.
+ * This folds constant arithmetic, removes no-op adjusts, removes adjusts whose result is discarded by a later RST,
+ * removes temporary storage stores which are overwritten before they can be read, and converts large dense range lists
+ * into a jump table. The optimised form is functionally identical to the original.
+ * @param group Group to optimise.
+ * @param stats Statistics of the GRF, to update.
+ */
+void OptimiseDeterministicSpriteGroup(DeterministicSpriteGroup *group, VarAction2OptimiseStats &stats)
+{
+	stats.groups++;
+	stats.adjusts += (uint32)group->adjusts.size();
+	const size_t original_size = group->adjusts.size();
+
+	/* Constant folding and no-op removal */
+	std::vector<DeterministicSpriteGroupAdjust> out;
+	out.reserve(group->adjusts.size());
+	bool known = true;
+	uint32 known_value = 0;
+	bool last_out_is_constant = false;
+	for (size_t i = 0; i < group->adjusts.size(); i++) {
+		DeterministicSpriteGroupAdjust current = group->adjusts[i];
+		/* The first adjust is an ADD to 0, which is equivalent to RST */
+		if (i == 0 && current.operation == DSGA_OP_ADD) current.operation = DSGA_OP_RST;
+
+		if (IsVarAction2AdjustConstant(current) && IsVarAction2AdjustOperationPure(current)) {
+			if (current.operation != DSGA_OP_RST && IsVarAction2AdjustNoOp(group->size, current)) {
+				stats.noops_removed++;
+				continue;
+			}
+			if (known || current.operation == DSGA_OP_RST) {
+				known_value = EvalAdjust(group->size, current, nullptr, known_value, UINT_MAX);
+				known = true;
+				if (last_out_is_constant) {
+					out.back() = MakeVarAction2ConstantAdjust(known_value);
+					stats.constants_folded++;
+				} else {
+					out.push_back(MakeVarAction2ConstantAdjust(known_value));
+					last_out_is_constant = true;
+				}
+				continue;
+			}
+		}
+
+		/* Stores return last_value unchanged */
+		if (current.operation != DSGA_OP_STO && current.operation != DSGA_OP_STOP) known = false;
+		last_out_is_constant = false;
+		out.push_back(current);
+	}
+
+	/* Dead adjust elimination: pure adjusts before an RST which does not read last_value have no effect */
+	for (size_t i = out.size(); i > 0; i--) {
+		const DeterministicSpriteGroupAdjust &rst = out[i - 1];
+		if (rst.operation != DSGA_OP_RST || rst.variable == 0x7B) continue;
+		size_t first = i - 1;
+		while (first > 0 && IsVarAction2AdjustOperationPure(out[first - 1]) && IsVarAction2AdjustVariablePure(out[first - 1])) {
+			first--;
+		}
+		if (first < i - 1) {
+			stats.dead_adjusts += (uint32)(i - 1 - first);
+			out.erase(out.begin() + first, out.begin() + i - 1);
+			i = first + 1;
+		}
+	}
+
+	/* Dead store elimination: a store to a constant temporary storage register which is overwritten by a later store
+	 * to the same register, with no possible read of the register in between */
+	for (size_t i = 0; i < out.size(); i++) {
+		const DeterministicSpriteGroupAdjust &store = out[i];
+		if (store.operation != DSGA_OP_STO || !IsVarAction2AdjustConstant(store)) continue;
+		const uint32 reg = GetVarAction2AdjustConstantValue(group->size, store);
+		for (size_t j = i + 1; j < out.size(); j++) {
+			const DeterministicSpriteGroupAdjust &next = out[j];
+			if (!IsVarAction2AdjustVariablePure(next)) break;
+			if (next.variable == 0x7D && next.parameter == reg) break;
+			if (next.operation == DSGA_OP_STO && IsVarAction2AdjustConstant(next) && GetVarAction2AdjustConstantValue(group->size, next) == reg) {
+				stats.dead_stores++;
+				out.erase(out.begin() + i);
+				i--;
+				break;
+			}
+		}
+	}
+
+	/* Always retain at least one adjust, such that the group evaluation is unchanged */
+	if (out.empty()) out.push_back(MakeVarAction2ConstantAdjust(0));
+
+	stats.adjusts_removed += (uint32)(original_size - std::min(original_size, out.size()));
+	group->adjusts = std::move(out);
+
+	/* Jump table conversion of large, dense range lists */
+	group->jump_table_base = 0;
+	if (!group->calculated_result && group->ranges.size() > 4) {
+		const uint32 low = group->ranges.front().low;
+		const uint32 high = group->ranges.back().high;
+		const uint32 span = high - low;
+		if (span < 256 || span < group->ranges.size() * 4) {
+			group->jump_table.assign(span + 1, group->default_group);
+			for (const DeterministicSpriteGroupRange &range : group->ranges) {
+				std::fill(group->jump_table.begin() + (range.low - low), group->jump_table.begin() + (range.high - low) + 1, range.group);
+			}
+			group->jump_table_base = low;
+			stats.jump_tables++;
+		}
+	}
+}
+
 const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) const
 {
 	uint32 last_value = 0;
@@ -239,7 +463,10 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 		return &nvarzero;
 	}
 
-	if (this->ranges.size() > 4) {
+	if (!this->jump_table.empty()) {
+		const uint32 index = value - this->jump_table_base;
+		return SpriteGroup::Resolve(index < this->jump_table.size() ? this->jump_table[index] : this->default_group, object, false);
+	} else if (this->ranges.size() > 4) {
 		const auto &lower = std::lower_bound(this->ranges.begin(), this->ranges.end(), value, RangeHighComparator);
 		if (lower != this->ranges.end() && lower->low <= value) {
 			assert(lower->low <= value && value <= lower->high);
@@ -88,6 +88,9 @@ public:
 	virtual void AnalyseCallbacks(AnalyseCallbackOperation &op) const {};
 
 	static const SpriteGroup *Resolve(const SpriteGroup *group, ResolverObject &object, bool top_level = true);
+
+private:
+	static const SpriteGroup *ResolveProfiled(const SpriteGroup *group, ResolverObject &object, bool top_level);
 };
 
 
@@ -197,6 +200,9 @@ struct DeterministicSpriteGroup : SpriteGroup {
 
 	const SpriteGroup *error_group; // was first range, before sorting ranges
 
+	std::vector<const SpriteGroup *> jump_table; ///< Dense lookup table of ranges, built by the load-time optimiser, indexed by (value - jump_table_base)
+	uint32 jump_table_base;
+
 	void AnalyseCallbacks(AnalyseCallbackOperation &op) const override;
 
 protected:
@@ -437,6 +443,9 @@ struct ResolverObject {
 	virtual uint32 GetDebugID() const { return 0; }
 };
 
+struct VarAction2OptimiseStats;
+void OptimiseDeterministicSpriteGroup(DeterministicSpriteGroup *group, VarAction2OptimiseStats &stats);
+
 void DumpSpriteGroup(const SpriteGroup *sg, std::function<void(const char *)> print);
 
 #endif /* NEWGRF_SPRITEGROUP_H */
@@ -32,6 +32,7 @@
 #include "screenshot.h"
 #include "network/network.h"
 #include "network/network_func.h"
+#include "network/network_desync_test.h"
 #include "ai/ai.hpp"
 #include "ai/ai_config.hpp"
 #include "settings_func.h"
@@ -59,6 +60,7 @@
 #include "misc/getoptdata.h"
 #include "game/game.hpp"
 #include "game/game_config.hpp"
+#include "script/script_instance.hpp"
 #include "town.h"
 #include "subsidy_func.h"
 #include "gfx_layout.h"
@@ -1402,10 +1404,14 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 	}
 
 	std::vector<IndustryList> old_station_industries_nears;
+	std::vector<NearbyTownList> old_station_towns_catchments;
+	std::vector<IndustryList> old_station_industries_catchments;
 	std::vector<BitmapTileArea> old_station_catchment_tiles;
 	std::vector<uint> old_station_tiles;
 	for (Station *st : Station::Iterate()) {
 		old_station_industries_nears.push_back(st->industries_near);
+		old_station_towns_catchments.push_back(st->towns_catchment);
+		old_station_industries_catchments.push_back(st->industries_catchment);
 		old_station_catchment_tiles.push_back(st->catchment_tiles);
 		old_station_tiles.push_back(st->station_tiles);
 	}
@@ -1436,6 +1442,12 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log)
 		if (old_station_industries_nears[i] != st->industries_near) {
 			CCLOG("station industries_near mismatch: st %i, (old size: %u, new size: %u)", (int)st->index, (uint)old_station_industries_nears[i].size(), (uint)st->industries_near.size());
 		}
+		if (old_station_towns_catchments[i] != st->towns_catchment) {
+			CCLOG("station towns_catchment mismatch: st %i, (old size: %u, new size: %u)", (int)st->index, (uint)old_station_towns_catchments[i].size(), (uint)st->towns_catchment.size());
+		}
+		if (old_station_industries_catchments[i] != st->industries_catchment) {
+			CCLOG("station industries_catchment mismatch: st %i, (old size: %u, new size: %u)", (int)st->index, (uint)old_station_industries_catchments[i].size(), (uint)st->industries_catchment.size());
+		}
 		if (!(old_station_catchment_tiles[i] == st->catchment_tiles)) {
 			CCLOG("station catchment_tiles mismatch: st %i", (int)st->index);
 		}
@@ -1796,7 +1808,11 @@ void StateGameLoop()
 
 		if (!HasModalProgress()) UpdateLandscapingLimits();
 #ifndef DEBUG_DUMP_COMMANDS
-		Game::GameLoop();
+		if (!_network_desync_test_replay) {
+			ScriptInstance::BeginOpcodeBudget();
+			Game::ScheduleOpcodeBudget();
+			Game::GameLoop();
+		}
 #endif
 		return;
 	}
@@ -1848,8 +1864,12 @@ void StateGameLoop()
 		BasePersistentStorageArray::SwitchMode(PSM_LEAVE_GAMELOOP);
 
 #ifndef DEBUG_DUMP_COMMANDS
-		{
+		/* Scripts only issue commands, which the desync self-test replays from its recording. */
+		if (!_network_desync_test_replay) {
 			PerformanceMeasurer framerate(PFE_ALLSCRIPTS);
+			ScriptInstance::BeginOpcodeBudget();
+			AI::ScheduleOpcodeBudget();
+			Game::ScheduleOpcodeBudget();
 			AI::GameLoop();
 			Game::GameLoop();
 		}
@@ -0,0 +1,298 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file water_regions.cpp Handles dividing the water in the map into square regions to assist pathfinding.
+ * Each region is divided into patches of water which are connected within the region, and remembers along
+ * which tiles of its edges ships can leave it. This is computed when first needed and whenever a tile of the
+ * region, or a tile bordering it, has changed its type.
+ */
+
+#include "../stdafx.h"
+#include "../ship.h"
+#include "../landscape.h"
+#include "../track_func.h"
+#include "../tunnelbridge_map.h"
+#include "follow_track.hpp"
+#include "water_regions.h"
+
+#include <array>
+#include <memory>
+
+#include "../safeguards.h"
+
+static const uint WATER_REGION_EDGE_MASK = WATER_REGION_EDGE_LENGTH - 1; ///< Mask of the tile coordinate within a water region.
+
+typedef std::array<TWaterRegionPatchLabel, WATER_REGION_NUMBER_OF_TILES> WaterRegionPatchLabels;
+
+/** The connectivity of the water within a single water region. */
+struct WaterRegion {
+	std::unique_ptr<WaterRegionPatchLabels> tile_patch_labels; ///< Patch label of each tile, only when there is more than one patch
+	uint16 edge_traversability_bits[DIAGDIR_END] = {};         ///< For each side, one bit per tile along it: whether ships can leave the region there
+	uint8 number_of_patches = 0;                               ///< Number of patches of water in the region
+	bool has_cross_region_aqueducts = false;                   ///< Whether aqueducts lead from this region into another region
+	bool initialized = false;                                  ///< Whether the data matches the map
+};
+
+static std::vector<WaterRegion> _water_regions; ///< All water regions, by row.
+static uint _water_regions_x = 0;               ///< Number of water regions in X direction.
+static uint _water_regions_y = 0;               ///< Number of water regions in Y direction.
+
+/**
+ * Get the trackdirs ships can use on a tile.
+ * @param tile The tile.
+ * @return The trackdirs, none if the tile is not water traversable.
+ */
+static inline TrackdirBits GetWaterTrackdirs(TileIndex tile)
+{
+	return TrackStatusToTrackdirBits(GetTileTrackStatus(tile, TRANSPORT_WATER, 0));
+}
+
+/**
+ * Get the index of a tile within its water region.
+ * @param tile The tile.
+ * @return The index within the region.
+ */
+static inline uint GetLocalTileIndex(TileIndex tile)
+{
+	return ((TileY(tile) & WATER_REGION_EDGE_MASK) << WATER_REGION_EDGE_BITS) | (TileX(tile) & WATER_REGION_EDGE_MASK);
+}
+
+/**
+ * Get the tile at an index within a water region.
+ * @param x X coordinate of the water region.
+ * @param y Y coordinate of the water region.
+ * @param local_index Index of the tile within the region.
+ * @return The tile.
+ */
+static inline TileIndex GetTileFromLocalIndex(uint x, uint y, uint local_index)
+{
+	return TileXY((x << WATER_REGION_EDGE_BITS) + (local_index & WATER_REGION_EDGE_MASK), (y << WATER_REGION_EDGE_BITS) + (local_index >> WATER_REGION_EDGE_BITS));
+}
+
+/**
+ * Get the tile at a position along a side of a water region.
+ * @param x X coordinate of the water region.
+ * @param y Y coordinate of the water region.
+ * @param side The side of the region.
+ * @param position Position of the tile along the side.
+ * @return The tile.
+ */
+static TileIndex GetEdgeTile(uint x, uint y, DiagDirection side, uint position)
+{
+	uint local_x, local_y;
+	switch (side) {
+		case DIAGDIR_NE: local_x = 0;                      local_y = position;                break;
+		case DIAGDIR_SW: local_x = WATER_REGION_EDGE_MASK; local_y = position;                break;
+		case DIAGDIR_NW: local_x = position;               local_y = 0;                       break;
+		case DIAGDIR_SE: local_x = position;               local_y = WATER_REGION_EDGE_MASK; break;
+		default: NOT_REACHED();
+	}
+	return GetTileFromLocalIndex(x, y, (local_y << WATER_REGION_EDGE_BITS) | local_x);
+}
+
+/**
+ * Recompute the patches and the traversable edges of a water region from the map.
+ * @param region The region to update.
+ * @param x X coordinate of the water region.
+ * @param y Y coordinate of the water region.
+ */
+static void UpdateWaterRegion(WaterRegion &region, uint x, uint y)
+{
+	WaterRegionPatchLabels labels;
+	labels.fill(INVALID_WATER_REGION_PATCH);
+	MemSetT(region.edge_traversability_bits, 0, lengthof(region.edge_traversability_bits));
+	region.number_of_patches = 0;
+	region.has_cross_region_aqueducts = false;
+
+	const uint region_x = x << WATER_REGION_EDGE_BITS;
+	const uint region_y = y << WATER_REGION_EDGE_BITS;
+	auto contains_tile = [&](TileIndex tile) -> bool {
+		return TileX(tile) - region_x < WATER_REGION_EDGE_LENGTH && TileY(tile) - region_y < WATER_REGION_EDGE_LENGTH;
+	};
+
+	std::vector<TileIndex> tiles_to_visit;
+	for (uint local_index = 0; local_index < WATER_REGION_NUMBER_OF_TILES; local_index++) {
+		if (labels[local_index] != INVALID_WATER_REGION_PATCH) continue;
+
+		TileIndex start_tile = GetTileFromLocalIndex(x, y, local_index);
+		if (GetWaterTrackdirs(start_tile) == TRACKDIR_BIT_NONE) continue;
+
+		/* In the unlikely case of more patches than labels, the last label is shared. */
+		if (region.number_of_patches < UINT8_MAX) region.number_of_patches++;
+		const TWaterRegionPatchLabel label = region.number_of_patches;
+
+		/* Flood fill the patch, following the water tracks of each tile. */
+		labels[local_index] = label;
+		tiles_to_visit.push_back(start_tile);
+		while (!tiles_to_visit.empty()) {
+			TileIndex tile = tiles_to_visit.back();
+			tiles_to_visit.pop_back();
+
+			TrackdirBits trackdirs = GetWaterTrackdirs(tile);
+			while (trackdirs != TRACKDIR_BIT_NONE) {
+				Trackdir td = RemoveFirstTrackdir(&trackdirs);
+				CFollowTrackWater ft;
+				if (!ft.Follow(tile, td)) continue;
+
+				if (contains_tile(ft.m_new_tile)) {
+					TWaterRegionPatchLabel &new_label = labels[GetLocalTileIndex(ft.m_new_tile)];
+					if (new_label == INVALID_WATER_REGION_PATCH) {
+						new_label = label;
+						tiles_to_visit.push_back(ft.m_new_tile);
+					}
+				} else if (DistanceManhattan(tile, ft.m_new_tile) == 1) {
+					/* Leaving the region into the adjacent one. */
+					uint position = DiagDirToAxis(ft.m_exitdir) == AXIS_X ? (TileY(tile) & WATER_REGION_EDGE_MASK) : (TileX(tile) & WATER_REGION_EDGE_MASK);
+					SetBit(region.edge_traversability_bits[ft.m_exitdir], position);
+				} else {
+					/* Crossing an aqueduct into another region. */
+					region.has_cross_region_aqueducts = true;
+				}
+			}
+		}
+	}
+
+	/* With at most one patch, every water tile is in patch 1, so the labels need not be stored. */
+	if (region.number_of_patches > 1) {
+		if (region.tile_patch_labels == nullptr) region.tile_patch_labels.reset(new WaterRegionPatchLabels());
+		*region.tile_patch_labels = labels;
+	} else {
+		region.tile_patch_labels.reset();
+	}
+	region.initialized = true;
+}
+
+/**
+ * Get a water region, updating it first when the map has changed.
+ * @param x X coordinate of the water region.
+ * @param y Y coordinate of the water region.
+ * @return The water region.
+ */
+static const WaterRegion &GetUpdatedWaterRegion(uint x, uint y)
+{
+	WaterRegion &region = _water_regions[y * _water_regions_x + x];
+	if (!region.initialized) UpdateWaterRegion(region, x, y);
+	return region;
+}
+
+/**
+ * Get the patch label of a tile within an up to date water region.
+ * @param region The water region of the tile.
+ * @param tile The tile.
+ * @return The label, #INVALID_WATER_REGION_PATCH if the tile is not water traversable.
+ */
+static TWaterRegionPatchLabel GetTilePatchLabel(const WaterRegion &region, TileIndex tile)
+{
+	if (region.tile_patch_labels != nullptr) return (*region.tile_patch_labels)[GetLocalTileIndex(tile)];
+	if (region.number_of_patches == 0 || GetWaterTrackdirs(tile) == TRACKDIR_BIT_NONE) return INVALID_WATER_REGION_PATCH;
+	return 1;
+}
+
+/** Size the water regions to the map, all of them have to be computed again. */
+void AllocateWaterRegions()
+{
+	_water_regions_x = MapSizeX() >> WATER_REGION_EDGE_BITS;
+	_water_regions_y = MapSizeY() >> WATER_REGION_EDGE_BITS;
+	_water_regions.clear();
+	_water_regions.resize(_water_regions_x * _water_regions_y);
+}
+
+/**
+ * Mark the water region of a tile as changed. When the tile is on the edge of its
+ * region, whether ships can leave the adjacent region towards it may have changed too.
+ * @param tile The tile which has changed.
+ */
+void InvalidateWaterRegion(TileIndex tile)
+{
+	const uint x = TileX(tile) >> WATER_REGION_EDGE_BITS;
+	const uint y = TileY(tile) >> WATER_REGION_EDGE_BITS;
+	if (x >= _water_regions_x || y >= _water_regions_y) return;
+
+	auto invalidate = [](uint x, uint y) {
+		if (x < _water_regions_x && y < _water_regions_y) _water_regions[y * _water_regions_x + x].initialized = false;
+	};
+	invalidate(x, y);
+
+	const uint local_x = TileX(tile) & WATER_REGION_EDGE_MASK;
+	const uint local_y = TileY(tile) & WATER_REGION_EDGE_MASK;
+	if (local_x == 0) invalidate(x - 1, y);
+	if (local_x == WATER_REGION_EDGE_MASK) invalidate(x + 1, y);
+	if (local_y == 0) invalidate(x, y - 1);
+	if (local_y == WATER_REGION_EDGE_MASK) invalidate(x, y + 1);
+}
+
+/**
+ * Get the water region patch a tile is in.
+ * @param tile The tile.
+ * @return The water region and label of the patch, the label is #INVALID_WATER_REGION_PATCH if the tile is not water traversable.
+ */
+WaterRegionPatchDesc GetWaterRegionPatchInfo(TileIndex tile)
+{
+	const uint x = TileX(tile) >> WATER_REGION_EDGE_BITS;
+	const uint y = TileY(tile) >> WATER_REGION_EDGE_BITS;
+	return { x, y, GetTilePatchLabel(GetUpdatedWaterRegion(x, y), tile) };
+}
+
+/**
+ * Get the tile in the middle of the water region of a patch.
+ * @param water_region_patch The patch.
+ * @return The center tile.
+ */
+TileIndex GetWaterRegionCenterTile(const WaterRegionPatchDesc &water_region_patch)
+{
+	return TileXY((water_region_patch.x << WATER_REGION_EDGE_BITS) + WATER_REGION_EDGE_LENGTH / 2, (water_region_patch.y << WATER_REGION_EDGE_BITS) + WATER_REGION_EDGE_LENGTH / 2);
+}
+
+/**
+ * Get the patches of other water regions ships can move to directly from a patch.
+ * @param water_region_patch The patch to start from.
+ * @param[out] neighbours The neighbouring patches are added to this, each one once.
+ */
+void GetWaterRegionPatchNeighbours(const WaterRegionPatchDesc &water_region_patch, std::vector<WaterRegionPatchDesc> &neighbours)
+{
+	auto add_neighbour = [&neighbours](const WaterRegionPatchDesc &patch) {
+		if (std::find(neighbours.begin(), neighbours.end(), patch) == neighbours.end()) neighbours.push_back(patch);
+	};
+
+	const uint x = water_region_patch.x;
+	const uint y = water_region_patch.y;
+	const WaterRegion &region = GetUpdatedWaterRegion(x, y);
+
+	for (DiagDirection side = DIAGDIR_BEGIN; side < DIAGDIR_END; side++) {
+		uint edge_bits = region.edge_traversability_bits[side];
+		if (edge_bits == 0) continue;
+
+		const TileIndexDiffC offset = TileIndexDiffCByDiagDir(side);
+		const uint neighbour_x = x + offset.x;
+		const uint neighbour_y = y + offset.y;
+		if (neighbour_x >= _water_regions_x || neighbour_y >= _water_regions_y) continue;
+		const WaterRegion &neighbour_region = GetUpdatedWaterRegion(neighbour_x, neighbour_y);
+
+		while (edge_bits != 0) {
+			uint position = FindFirstBit(edge_bits);
+			ClrBit(edge_bits, position);
+
+			TileIndex tile = GetEdgeTile(x, y, side, position);
+			if (GetTilePatchLabel(region, tile) != water_region_patch.label) continue;
+
+			TWaterRegionPatchLabel neighbour_label = GetTilePatchLabel(neighbour_region, TileAddByDiagDir(tile, side));
+			if (neighbour_label != INVALID_WATER_REGION_PATCH) add_neighbour({ neighbour_x, neighbour_y, neighbour_label });
+		}
+	}
+
+	if (region.has_cross_region_aqueducts) {
+		for (uint local_index = 0; local_index < WATER_REGION_NUMBER_OF_TILES; local_index++) {
+			TileIndex tile = GetTileFromLocalIndex(x, y, local_index);
+			if (!IsBridgeTile(tile) || GetTunnelBridgeTransportType(tile) != TRANSPORT_WATER) continue;
+			if (GetTilePatchLabel(region, tile) != water_region_patch.label) continue;
+
+			WaterRegionPatchDesc other_end = GetWaterRegionPatchInfo(GetOtherTunnelBridgeEnd(tile));
+			if ((other_end.x != x || other_end.y != y) && other_end.label != INVALID_WATER_REGION_PATCH) add_neighbour(other_end);
+		}
+	}
+}
@@ -0,0 +1,44 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file water_regions.h Handles dividing the water in the map into square regions to assist pathfinding. */
+
+#ifndef WATER_REGIONS_H
+#define WATER_REGIONS_H
+
+#include "../tile_type.h"
+#include <vector>
+
+typedef uint8 TWaterRegionPatchLabel; ///< Label of a connected patch of water within a water region.
+
+static const uint WATER_REGION_EDGE_BITS = 4;                                  ///< Number of bits of the edge length of a water region.
+static const uint WATER_REGION_EDGE_LENGTH = 1 << WATER_REGION_EDGE_BITS;       ///< Number of tiles along each edge of a water region.
+static const uint WATER_REGION_NUMBER_OF_TILES = WATER_REGION_EDGE_LENGTH * WATER_REGION_EDGE_LENGTH; ///< Number of tiles in a water region.
+
+static const TWaterRegionPatchLabel INVALID_WATER_REGION_PATCH = 0; ///< Label of tiles which are not water traversable.
+
+/**
+ * Describes a single connected patch of water within a water region.
+ * Tiles of the same water region with the same label are connected to each other without leaving the region.
+ */
+struct WaterRegionPatchDesc {
+	uint x;                       ///< X coordinate of the water region, in regions
+	uint y;                       ///< Y coordinate of the water region, in regions
+	TWaterRegionPatchLabel label; ///< Label of the patch within the water region
+
+	bool operator==(const WaterRegionPatchDesc &other) const { return this->x == other.x && this->y == other.y && this->label == other.label; }
+	bool operator!=(const WaterRegionPatchDesc &other) const { return !(*this == other); }
+};
+
+void AllocateWaterRegions();
+void InvalidateWaterRegion(TileIndex tile);
+
+WaterRegionPatchDesc GetWaterRegionPatchInfo(TileIndex tile);
+TileIndex GetWaterRegionCenterTile(const WaterRegionPatchDesc &water_region_patch);
+void GetWaterRegionPatchNeighbours(const WaterRegionPatchDesc &water_region_patch, std::vector<WaterRegionPatchDesc> &neighbours);
+
+#endif /* WATER_REGIONS_H */
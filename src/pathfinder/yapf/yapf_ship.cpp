@@ -11,12 +11,115 @@
 #include "../../ship.h"
 #include "../../industry.h"
 #include "../../vehicle_func.h"
+#include "../../station_base.h"
+#include "../water_regions.h"
 
 #include "yapf.hpp"
 #include "yapf_node_ship.hpp"
 
+#include <queue>
+#include <unordered_map>
+
 #include "../../safeguards.h"
 
+/** Number of water regions beyond the current one the tile based search is allowed to look into. */
+static const uint NUMBER_OF_WATER_REGIONS_LOOKAHEAD = 4;
+
+/**
+ * Find a route over water region patches from a tile to the destination of a ship.
+ * Patches are connected when a ship can move directly from one to the other, each step costs the
+ * distance between the regions, which also serves as estimate towards the destination.
+ * @param v The ship.
+ * @param start_tile The tile to start from.
+ * @return The patches on the route, starting with the patch of \a start_tile, empty if there is no route.
+ */
+static std::vector<WaterRegionPatchDesc> FindWaterRegionPath(const Ship *v, TileIndex start_tile)
+{
+	std::vector<WaterRegionPatchDesc> path;
+
+	const WaterRegionPatchDesc start = GetWaterRegionPatchInfo(start_tile);
+	if (start.label == INVALID_WATER_REGION_PATCH) return path;
+
+	std::vector<WaterRegionPatchDesc> destinations;
+	auto add_destination = [&](TileIndex tile) {
+		WaterRegionPatchDesc patch = GetWaterRegionPatchInfo(tile);
+		if (patch.label != INVALID_WATER_REGION_PATCH && std::find(destinations.begin(), destinations.end(), patch) == destinations.end()) destinations.push_back(patch);
+	};
+	if (v->current_order.IsType(OT_GOTO_STATION)) {
+		const Station *st = Station::GetIfValid(v->current_order.GetDestination());
+		if (st == nullptr) return path;
+		TILE_AREA_LOOP(tile, st->docking_station) {
+			if (IsDockingTile(tile) && IsShipDestinationTile(tile, st->index)) add_destination(tile);
+		}
+	} else if (v->dest_tile != INVALID_TILE) {
+		add_destination(v->dest_tile);
+	}
+	if (destinations.empty()) return path;
+
+	auto key = [](const WaterRegionPatchDesc &patch) -> uint64 {
+		return ((uint64)patch.x << 40) | ((uint64)patch.y << 8) | patch.label;
+	};
+	auto distance = [](const WaterRegionPatchDesc &a, const WaterRegionPatchDesc &b) -> uint {
+		return Delta(a.x, b.x) + Delta(a.y, b.y);
+	};
+	auto estimate = [&](const WaterRegionPatchDesc &patch) -> uint {
+		uint best = UINT_MAX;
+		for (const WaterRegionPatchDesc &dest : destinations) best = std::min(best, distance(patch, dest));
+		return best;
+	};
+
+	struct PatchNode {
+		WaterRegionPatchDesc patch;
+		WaterRegionPatchDesc parent;
+		uint cost;
+		bool closed;
+	};
+	std::unordered_map<uint64, PatchNode> nodes;
+
+	/* Open list ordered by estimated total cost, ties are broken by key so the search is deterministic. */
+	typedef std::pair<uint, uint64> OpenItem;
+	std::priority_queue<OpenItem, std::vector<OpenItem>, std::greater<OpenItem>> open;
+
+	nodes[key(start)] = { start, start, 0, false };
+	open.push({ estimate(start), key(start) });
+
+	std::vector<WaterRegionPatchDesc> neighbours;
+	while (!open.empty()) {
+		uint64 current_key = open.top().second;
+		open.pop();
+
+		PatchNode &current = nodes[current_key];
+		if (current.closed) continue;
+		current.closed = true;
+		const WaterRegionPatchDesc patch = current.patch;
+		const uint cost = current.cost;
+
+		if (std::find(destinations.begin(), destinations.end(), patch) != destinations.end()) {
+			/* Walk back to the start. */
+			for (WaterRegionPatchDesc p = patch; p != start; p = nodes[key(p)].parent) path.push_back(p);
+			path.push_back(start);
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		neighbours.clear();
+		GetWaterRegionPatchNeighbours(patch, neighbours);
+		for (const WaterRegionPatchDesc &neighbour : neighbours) {
+			uint neighbour_cost = cost + distance(patch, neighbour);
+			auto result = nodes.insert({ key(neighbour), { neighbour, patch, neighbour_cost, false } });
+			PatchNode &node = result.first->second;
+			if (!result.second) {
+				if (node.closed || node.cost <= neighbour_cost) continue;
+				node.parent = patch;
+				node.cost = neighbour_cost;
+			}
+			open.push({ neighbour_cost + estimate(neighbour), key(neighbour) });
+		}
+	}
+
+	return path;
+}
+
 template <class Types>
 class CYapfDestinationTileWaterT
 {
@@ -31,6 +134,9 @@ protected:
 	TrackdirBits m_destTrackdirs;
 	StationID    m_destStation;
 
+	bool                 m_has_intermediate_dest = false; ///< Whether the search ends in a water region patch on the way, instead of at the destination
+	WaterRegionPatchDesc m_intermediate_dest_patch;       ///< The water region patch the search ends in
+
 public:
 	void SetDestination(const Ship *v)
 	{
@@ -45,6 +151,17 @@ public:
 		}
 	}
 
+	/**
+	 * End the search in a water region patch on the way to the destination.
+	 * @param water_region_patch The patch.
+	 */
+	void SetIntermediateDestination(const WaterRegionPatchDesc &water_region_patch)
+	{
+		m_has_intermediate_dest   = true;
+		m_intermediate_dest_patch = water_region_patch;
+		m_destTile                = GetWaterRegionCenterTile(water_region_patch);
+	}
+
 protected:
 	/** to access inherited path finder */
 	inline Tpf& Yapf()
@@ -61,6 +178,10 @@ public:
 
 	inline bool PfDetectDestinationTile(TileIndex tile, Trackdir trackdir)
 	{
+		if (m_has_intermediate_dest) {
+			return GetWaterRegionPatchInfo(tile) == m_intermediate_dest_patch;
+		}
+
 		if (m_destStation != INVALID_STATION) {
 			return IsDockingTile(tile) && IsShipDestinationTile(tile, m_destStation);
 		}
@@ -110,12 +231,32 @@ public:
 	typedef typename Node::Key Key;                      ///< key to hash tables
 
 protected:
+	std::vector<WaterRegionPatchDesc> m_water_region_corridor; ///< Water region patches the search may enter, empty for all
+
 	/** to access inherited path finder */
 	inline Tpf& Yapf()
 	{
 		return *static_cast<Tpf *>(this);
 	}
 
+	/**
+	 * Plan the route of the ship over water regions, and restrict the search to the first regions on that route.
+	 * When the destination is further away, the search ends at the last of these regions.
+	 * When there is no route over water regions, the search is not restricted.
+	 * @param v The ship.
+	 * @param tile The first tile the search will visit after the origin.
+	 */
+	void RestrictToWaterRegionPath(const Ship *v, TileIndex tile)
+	{
+		std::vector<WaterRegionPatchDesc> path = FindWaterRegionPath(v, tile);
+		if (path.empty()) return;
+		if (path.size() > NUMBER_OF_WATER_REGIONS_LOOKAHEAD + 1) {
+			path.resize(NUMBER_OF_WATER_REGIONS_LOOKAHEAD + 1);
+			Yapf().SetIntermediateDestination(path.back());
+		}
+		m_water_region_corridor = std::move(path);
+	}
+
 public:
 	/**
 	 * Called by YAPF to move from the given node to the next tile. For each
@@ -126,6 +267,7 @@ public:
 	{
 		TrackFollower F(Yapf().GetVehicle());
 		if (F.Follow(old_node.m_key.m_tile, old_node.m_key.m_td)) {
+			if (!m_water_region_corridor.empty() && std::find(m_water_region_corridor.begin(), m_water_region_corridor.end(), GetWaterRegionPatchInfo(F.m_new_tile)) == m_water_region_corridor.end()) return;
 			Yapf().AddMultipleNodes(&old_node, F);
 		}
 	}
@@ -163,6 +305,8 @@ public:
 		/* set origin and destination nodes */
 		pf.SetOrigin(src_tile, trackdirs);
 		pf.SetDestination(v);
+		/* only search the water regions on the way, the first move is always to tile */
+		pf.RestrictToWaterRegionPath(v, tile);
 		/* find best path */
 		path_found = pf.FindPath(v);
 
@@ -213,6 +357,8 @@ public:
 		/* set origin and destination nodes */
 		pf.SetOrigin(tile, TrackdirToTrackdirBits(td1) | TrackdirToTrackdirBits(td2));
 		pf.SetDestination(v);
+		/* only search the water regions on the way */
+		pf.RestrictToWaterRegionPath(v, tile);
 		/* find best path */
 		if (!pf.FindPath(v)) return false;
 
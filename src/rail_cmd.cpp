@@ -1213,6 +1213,20 @@ static CommandCost ValidateAutoDrag(Trackdir *trackdir, TileIndex start, TileInd
 	return CommandCost();
 }
 
+/**
+ * Check whether a plan recorded by the test run of CmdRailTrackHelper can be replayed.
+ * @param plan The plan.
+ * @return true if the plan consists of valid steps followed by the end tile.
+ */
+static bool IsValidRailTrackPlan(const CommandExecPlan &plan)
+{
+	if (plan.read_pos != 0 || !plan.complete || plan.data.size() % 2 != 1) return false;
+	for (size_t i = 0; i + 1 < plan.data.size(); i += 2) {
+		if (plan.data[i] >= MapSize() || plan.data[i + 1] >= TRACKDIR_END || !IsValidTrackdir((Trackdir)plan.data[i + 1])) return false;
+	}
+	return true;
+}
+
 /**
  * Build or remove a stretch of railroad tracks.
  * @param tile start tile of drag
@@ -1245,6 +1259,49 @@ static CommandCost CmdRailTrackHelper(TileIndex tile, DoCommandFlag flags, uint3
 	TileIndex end_tile = p1;
 	Trackdir trackdir = TrackToTrackdir(track);
 
+	auto do_single_rail = [&](TileIndex step_tile, Trackdir step_trackdir) -> CommandCost {
+		return DoCommand(step_tile, remove ? 0 : railtype, TrackdirToTrack(step_trackdir) | (auto_remove_signals << 3) | (no_custom_bridge_heads ? 1 << 4 : 0) | (no_dual_rail_type ? 1 << 5 : 0), flags, remove ? CMD_REMOVE_SINGLE_RAIL : CMD_BUILD_SINGLE_RAIL);
+	};
+
+	/* The test run records the tiles on which building or removing succeeded,
+	 * so the execution run does not have to retry the tiles which failed. */
+	CommandExecPlan *plan = GetCommandExecPlan(remove ? CMD_REMOVE_RAILROAD_TRACK : CMD_BUILD_RAILROAD_TRACK, flags);
+	if (plan != nullptr && (flags & DC_EXEC)) {
+		if (IsValidRailTrackPlan(*plan)) {
+			CommandCost last_error = CMD_ERROR;
+			bool had_success = false;
+			uint32 step_tile = INVALID_TILE;
+			uint32 step_trackdir = INVALID_TRACKDIR;
+			uint32 endtile = INVALID_TILE;
+			while (plan->data.size() - plan->read_pos > 1 && plan->Read(step_tile) && plan->Read(step_trackdir)) {
+				TileIndex last_endtile = _rail_track_endtile;
+				CommandCost ret = do_single_rail(step_tile, (Trackdir)step_trackdir);
+				if (ret.Failed()) {
+					/* Stop where the normal loop would have stopped, should the execution differ from the test run. */
+					last_error = ret;
+					if (_rail_track_endtile == INVALID_TILE) _rail_track_endtile = last_endtile;
+					if (last_error.GetErrorMessage() != STR_ERROR_ALREADY_BUILT && !remove) {
+						if (fail_if_obstacle) return last_error;
+						return had_success ? total_cost : last_error;
+					}
+					if (last_error.GetErrorMessage() == STR_ERROR_OWNED_BY && remove) {
+						return had_success ? total_cost : last_error;
+					}
+				} else {
+					had_success = true;
+					total_cost.AddCost(ret);
+				}
+			}
+			if (plan->Read(endtile)) _rail_track_endtile = endtile;
+
+			if (had_success) return total_cost;
+			return last_error;
+		}
+
+		/* The plan cannot be replayed, build or remove the tracks the normal way without recording. */
+		plan = nullptr;
+	}
+
 	CommandCost ret = ValidateAutoDrag(&trackdir, tile, end_tile);
 	if (ret.Failed()) return ret;
 
@@ -1252,7 +1309,7 @@ static CommandCost CmdRailTrackHelper(TileIndex tile, DoCommandFlag flags, uint3
 	CommandCost last_error = CMD_ERROR;
 	for (;;) {
 		TileIndex last_endtile = _rail_track_endtile;
-		CommandCost ret = DoCommand(tile, remove ? 0 : railtype, TrackdirToTrack(trackdir) | (auto_remove_signals << 3) | (no_custom_bridge_heads ? 1 << 4 : 0) | (no_dual_rail_type ? 1 << 5 : 0), flags, remove ? CMD_REMOVE_SINGLE_RAIL : CMD_BUILD_SINGLE_RAIL);
+		CommandCost ret = do_single_rail(tile, trackdir);
 
 		if (ret.Failed()) {
 			last_error = ret;
@@ -1267,6 +1324,10 @@ static CommandCost CmdRailTrackHelper(TileIndex tile, DoCommandFlag flags, uint3
 		} else {
 			had_success = true;
 			total_cost.AddCost(ret);
+			if (plan != nullptr) {
+				plan->Add(tile);
+				plan->Add(trackdir);
+			}
 		}
 
 		if (tile == end_tile) break;
@@ -1277,6 +1338,11 @@ static CommandCost CmdRailTrackHelper(TileIndex tile, DoCommandFlag flags, uint3
 		if (!IsDiagonalTrackdir(trackdir)) ToggleBit(trackdir, 0);
 	}
 
+	if (plan != nullptr) {
+		plan->Add(_rail_track_endtile);
+		plan->SetComplete();
+	}
+
 	if (had_success) return total_cost;
 	return last_error;
 }
@@ -598,6 +598,8 @@ enum RailGroundType {
 
 static inline void SetRailGroundType(TileIndex t, RailGroundType rgt)
 {
+	/* Ships can use the water on the free halftile. */
+	if ((GB(_m[t].m4, 0, 4) == RAIL_GROUND_WATER) != (rgt == RAIL_GROUND_WATER)) InvalidateWaterRegion(t);
 	SB(_m[t].m4, 0, 4, rgt);
 }
 
@@ -679,19 +679,28 @@ struct RoadVehFindData {
 	Direction dir;
 };
 
+/**
+ * Extent of the area ahead of a road vehicle, per direction, in which another vehicle blocks it.
+ * The area ends just before the given offset from the position of the vehicle.
+ */
+static const int8 _road_veh_close_dist_x[] = { -4, -8, -4, -1, 4, 8, 4, 1 };
+static const int8 _road_veh_close_dist_y[] = { -4, -1, 4, 8, 4, 1, -4, -8 };
+
 static Vehicle *EnumCheckRoadVehClose(Vehicle *v, void *data)
 {
-	static const int8 dist_x[] = { -4, -8, -4, -1, 4, 8, 4, 1 };
-	static const int8 dist_y[] = { -4, -1, 4, 8, 4, 1, -4, -8 };
+	const int8 *dist_x = _road_veh_close_dist_x;
+	const int8 *dist_y = _road_veh_close_dist_y;
 
 	RoadVehFindData *rvf = (RoadVehFindData*)data;
 
+	/* Cheapest and most selective check first, in a jam about half the vehicles go the other way. */
+	if (v->direction != rvf->dir) return nullptr;
+
 	short x_diff = v->x_pos - rvf->x;
 	short y_diff = v->y_pos - rvf->y;
 
 	if (!v->IsInDepot() &&
 			abs(v->z_pos - rvf->veh->z_pos) < 6 &&
-			v->direction == rvf->dir &&
 			rvf->veh->First() != v->First() &&
 			(dist_x[v->direction] >= 0 || (x_diff > dist_x[v->direction] && x_diff <= 0)) &&
 			(dist_x[v->direction] <= 0 || (x_diff < dist_x[v->direction] && x_diff >= 0)) &&
@@ -725,7 +734,16 @@ static RoadVehicle *RoadVehFindCloseTo(RoadVehicle *v, int x, int y, Direction d
 		FindVehicleOnPos(v->tile, VEH_ROAD, &rvf, EnumCheckRoadVehClose);
 		FindVehicleOnPos(GetOtherTunnelBridgeEnd(v->tile), VEH_ROAD, &rvf, EnumCheckRoadVehClose);
 	} else {
-		FindVehicleOnPosXY(x, y, VEH_ROAD, &rvf, EnumCheckRoadVehClose);
+		/* Only visit the vehicles on the tiles under the area ahead, not all of those around the position.
+		 * The area is clipped to the collision distance of FindVehicleOnPosXY, so exactly the vehicles it found are found. */
+		const int COLL_DIST = 6;
+		const int dist_x = _road_veh_close_dist_x[dir];
+		const int dist_y = _road_veh_close_dist_y[dir];
+		const int xl = dist_x < 0 ? x + std::max(dist_x + 1, -COLL_DIST) : x;
+		const int yl = dist_y < 0 ? y + std::max(dist_y + 1, -COLL_DIST) : y;
+		const int xu = dist_x < 0 ? x : x + std::min(dist_x - 1, COLL_DIST);
+		const int yu = dist_y < 0 ? y : y + std::min(dist_y - 1, COLL_DIST);
+		FindVehicleOnPosXYArea(xl, yl, xu, yu, VEH_ROAD, &rvf, EnumCheckRoadVehClose);
 	}
 
 	/* This code protects a roadvehicle from being blocked for ever
@@ -19,6 +19,7 @@
 #include "../gfxinit.h"
 #include "../viewport_func.h"
 #include "../viewport_kdtree.h"
+#include "../depot_kdtree.h"
 #include "../industry.h"
 #include "../clear_map.h"
 #include "../vehicle_func.h"
@@ -67,6 +68,7 @@
 #include "../animated_tile.h"
 #include "../company_func.h"
 #include "../infrastructure_func.h"
+#include "../newgrf_profiling.h"
 
 
 #include "saveload_internal.h"
@@ -630,6 +632,8 @@ bool AfterLoadGame()
 
 	RebuildTownKdtree();
 	RebuildStationKdtree();
+	RebuildIndustryKdtree();
+	RebuildDepotKdtree();
 	UpdateCachedSnowLine();
 
 	_viewport_sign_kdtree_valid = false;
@@ -4031,6 +4035,9 @@ void ReloadNewGRFData()
 {
 	RegisterGameEvents(GEF_RELOAD_NEWGRF);
 
+	/* The sampled stacks refer to the GRF files which are about to be reloaded */
+	_newgrf_stack_profiler.Abort();
+
 	RailTypeLabel rail_type_label_map[RAILTYPE_END];
 	for (RailType rt = RAILTYPE_BEGIN; rt != RAILTYPE_END; rt++) {
 		rail_type_label_map[rt] = GetRailTypeInfo(rt)->label;
@@ -13,6 +13,7 @@
 #include "../core/endian_func.hpp"
 #include "../core/endian_type.hpp"
 #include "../fios.h"
+#include "../vehicle_func.h"
 #include <array>
 
 #include "saveload.h"
@@ -45,6 +46,9 @@ static void Load_MAPS()
 		SlErrorCorruptFmt("Invalid map size: %u x %u", _map_dim_x, _map_dim_y);
 	}
 	AllocateMap(_map_dim_x, _map_dim_y);
+
+	/* The vehicle tile hash is sized to the map. */
+	ResetVehicleHash();
 }
 
 static void Check_MAPS()
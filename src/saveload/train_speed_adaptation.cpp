@@ -28,7 +28,7 @@ static void Load_TSAS()
 	while ((index = SlIterateArray()) != -1) {
 		const_cast<SignalSpeedKey &>(data.first).signal_tile = index;
 		SlObject(&data, _train_speed_adaptation_map_desc);
-		_signal_speeds.insert(data);
+		_signal_speeds.Set(data.first, data.second);
 	}
 }
 
@@ -39,11 +39,11 @@ static void RealSave_TSAS(SignalSpeedType *data)
 
 static void Save_TSAS()
 {
-	for (auto &it : _signal_speeds) {
-		SlSetArrayIndex(it.first.signal_tile);
-		SignalSpeedType *data = &it;
-		SlAutolength((AutolengthProc*) RealSave_TSAS, data);
-	}
+	_signal_speeds.Iterate([](const SignalSpeedKey &key, const SignalSpeedValue &value) {
+		SignalSpeedType data(key, value);
+		SlSetArrayIndex(key.signal_tile);
+		SlAutolength((AutolengthProc*) RealSave_TSAS, &data);
+	});
 }
 
 extern const ChunkHandler _train_speed_adaptation_chunk_handlers[] = {
@@ -17,6 +17,14 @@
  *
  * This version is not yet released. The following changes are not set in stone yet.
  *
+ * API additions:
+ * \li AIIndustry::GetBulkCargoProperty
+ * \li AIIndustry::GetBulkProperty
+ * \li AIStation::GetBulkCargoProperty
+ * \li AITown::GetBulkCargoProperty
+ * \li AITown::GetBulkProperty
+ * \li AIVehicle::GetBulkProperty
+ *
  * \b 1.11.0
  *
  * API additions:
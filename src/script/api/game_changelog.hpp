@@ -17,6 +17,14 @@
  *
  * This version is not yet released. The following changes are not set in stone yet.
  *
+ * API additions:
+ * \li GSIndustry::GetBulkCargoProperty
+ * \li GSIndustry::GetBulkProperty
+ * \li GSStation::GetBulkCargoProperty
+ * \li GSTown::GetBulkCargoProperty
+ * \li GSTown::GetBulkProperty
+ * \li GSVehicle::GetBulkProperty
+ *
  * \b 1.11.0
  *
  * API additions:
@@ -11,6 +11,7 @@
 #include "script_industry.hpp"
 #include "script_cargo.hpp"
 #include "script_company.hpp"
+#include "script_controller.hpp"
 #include "script_error.hpp"
 #include "script_map.hpp"
 #include "../../company_base.h"
@@ -297,3 +298,47 @@ bool ScriptIndustry::SetControlFlags(IndustryID industry_id, uint32 control_flag
 	::Owner owner = (company == ScriptCompany::COMPANY_INVALID ? ::INVALID_OWNER : (::Owner)company);
 	return ScriptObject::DoCommand(0, industry_id, 2 | (((uint8)owner) << 16), CMD_INDUSTRY_CTRL);
 }
+
+/* static */ ScriptList *ScriptIndustry::GetBulkProperty(ScriptList *industry_list, BulkProperty property)
+{
+	if (industry_list == nullptr) return nullptr;
+
+	ScriptController::DecreaseOps((int)industry_list->items.size());
+
+	ScriptList *result = new ScriptList();
+	for (const auto &it : industry_list->items) {
+		const IndustryID industry_id = (IndustryID)it.first;
+		int64 value;
+		switch (property) {
+			case BP_LOCATION:                  value = GetLocation(industry_id); break;
+			case BP_INDUSTRY_TYPE:             value = GetIndustryType(industry_id); break;
+			case BP_AMOUNT_OF_STATIONS_AROUND: value = GetAmountOfStationsAround(industry_id); break;
+			default:                           value = -1; break;
+		}
+		result->AddItem(it.first, value);
+	}
+	return result;
+}
+
+/* static */ ScriptList *ScriptIndustry::GetBulkCargoProperty(ScriptList *industry_list, CargoID cargo_id, BulkCargoProperty property)
+{
+	if (industry_list == nullptr || !ScriptCargo::IsValidCargo(cargo_id)) return nullptr;
+
+	ScriptController::DecreaseOps((int)industry_list->items.size());
+
+	ScriptList *result = new ScriptList();
+	for (const auto &it : industry_list->items) {
+		const IndustryID industry_id = (IndustryID)it.first;
+		int64 value;
+		switch (property) {
+			case BCP_CARGO_ACCEPTED:                    value = IsCargoAccepted(industry_id, cargo_id); break;
+			case BCP_STOCKPILED_CARGO:                  value = GetStockpiledCargo(industry_id, cargo_id); break;
+			case BCP_LAST_MONTH_PRODUCTION:             value = GetLastMonthProduction(industry_id, cargo_id); break;
+			case BCP_LAST_MONTH_TRANSPORTED:            value = GetLastMonthTransported(industry_id, cargo_id); break;
+			case BCP_LAST_MONTH_TRANSPORTED_PERCENTAGE: value = GetLastMonthTransportedPercentage(industry_id, cargo_id); break;
+			default:                                    value = -1; break;
+		}
+		result->AddItem(it.first, value);
+	}
+	return result;
+}
@@ -12,6 +12,7 @@
 
 #include "script_company.hpp"
 #include "script_date.hpp"
+#include "script_list.hpp"
 #include "script_object.hpp"
 #include "../../industry.h"
 
@@ -311,6 +312,53 @@ public:
 	 */
 	static bool SetExclusiveConsumer(IndustryID industry_id, ScriptCompany::CompanyID company_id);
 
+	/**
+	 * Industry properties which can be queried for a whole list of industries at once.
+	 */
+	enum BulkProperty {
+		BP_LOCATION,                  ///< See GetLocation.
+		BP_INDUSTRY_TYPE,             ///< See GetIndustryType.
+		BP_AMOUNT_OF_STATIONS_AROUND, ///< See GetAmountOfStationsAround.
+	};
+
+	/**
+	 * Per-cargo industry properties which can be queried for a whole list of industries at once.
+	 */
+	enum BulkCargoProperty {
+		BCP_CARGO_ACCEPTED,                    ///< See IsCargoAccepted.
+		BCP_STOCKPILED_CARGO,                  ///< See GetStockpiledCargo.
+		BCP_LAST_MONTH_PRODUCTION,             ///< See GetLastMonthProduction.
+		BCP_LAST_MONTH_TRANSPORTED,            ///< See GetLastMonthTransported.
+		BCP_LAST_MONTH_TRANSPORTED_PERCENTAGE, ///< See GetLastMonthTransportedPercentage.
+	};
+
+	/**
+	 * Get a property of all industries in a list in one call.
+	 * This is equivalent to valuating a copy of the list with the matching
+	 *  getter, but is considerably cheaper for large lists.
+	 * @param industry_list The list of industries, for example a ScriptIndustryList.
+	 * @param property The property to get.
+	 * @pre industry_list != null.
+	 * @return A new list with the same items as industry_list, where the value of
+	 *  each item is the requested property, as returned by the matching getter.
+	 * @note This costs one opcode per industry in the list.
+	 */
+	static ScriptList *GetBulkProperty(ScriptList *industry_list, BulkProperty property);
+
+	/**
+	 * Get a per-cargo property of all industries in a list in one call.
+	 * This is equivalent to valuating a copy of the list with the matching
+	 *  getter, but is considerably cheaper for large lists.
+	 * @param industry_list The list of industries, for example a ScriptIndustryList.
+	 * @param cargo_id The cargo to get the property for.
+	 * @param property The property to get.
+	 * @pre industry_list != null.
+	 * @pre ScriptCargo::IsValidCargo(cargo_id).
+	 * @return A new list with the same items as industry_list, where the value of
+	 *  each item is the requested property, as returned by the matching getter.
+	 * @note This costs one opcode per industry in the list.
+	 */
+	static ScriptList *GetBulkCargoProperty(ScriptList *industry_list, CargoID cargo_id, BulkCargoProperty property);
 };
 
 #endif /* SCRIPT_INDUSTRY_HPP */
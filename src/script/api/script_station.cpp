@@ -12,6 +12,7 @@
 #include "script_map.hpp"
 #include "script_town.hpp"
 #include "script_cargo.hpp"
+#include "script_controller.hpp"
 #include "../../station_base.h"
 #include "../../roadstop_base.h"
 #include "../../town.h"
@@ -243,3 +244,25 @@ template<bool Tfrom, bool Tvia>
 
 	return ScriptObject::DoCommand(0, station_id, 0, CMD_OPEN_CLOSE_AIRPORT);
 }
+
+/* static */ ScriptList *ScriptStation::GetBulkCargoProperty(ScriptList *station_list, CargoID cargo_id, BulkCargoProperty property)
+{
+	if (station_list == nullptr || !ScriptCargo::IsValidCargo(cargo_id)) return nullptr;
+
+	ScriptController::DecreaseOps((int)station_list->items.size());
+
+	ScriptList *result = new ScriptList();
+	for (const auto &it : station_list->items) {
+		const StationID station_id = (StationID)it.first;
+		int64 value;
+		switch (property) {
+			case BCP_CARGO_WAITING: value = GetCargoWaiting(station_id, cargo_id); break;
+			case BCP_CARGO_PLANNED: value = GetCargoPlanned(station_id, cargo_id); break;
+			case BCP_CARGO_RATING:  value = GetCargoRating(station_id, cargo_id); break;
+			case BCP_HAS_RATING:    value = HasCargoRating(station_id, cargo_id) ? 1 : 0; break;
+			default:                value = -1; break;
+		}
+		result->AddItem(it.first, value);
+	}
+	return result;
+}
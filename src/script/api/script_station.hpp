@@ -12,6 +12,7 @@
 
 #include "script_road.hpp"
 #include "script_basestation.hpp"
+#include "script_list.hpp"
 #include "../../station_type.h"
 
 /**
@@ -293,6 +294,31 @@ public:
 	 */
 	static bool OpenCloseAirport(StationID station_id);
 
+	/**
+	 * Per-cargo station properties which can be queried for a whole list of stations at once.
+	 */
+	enum BulkCargoProperty {
+		BCP_CARGO_WAITING, ///< See GetCargoWaiting.
+		BCP_CARGO_PLANNED, ///< See GetCargoPlanned.
+		BCP_CARGO_RATING,  ///< See GetCargoRating.
+		BCP_HAS_RATING,    ///< See HasCargoRating.
+	};
+
+	/**
+	 * Get a per-cargo property of all stations in a list in one call.
+	 * This is equivalent to valuating a copy of the list with the matching
+	 *  getter, but is considerably cheaper for large lists.
+	 * @param station_list The list of stations, for example a ScriptStationList.
+	 * @param cargo_id The cargo to get the property for.
+	 * @param property The property to get.
+	 * @pre station_list != null.
+	 * @pre ScriptCargo::IsValidCargo(cargo_id).
+	 * @return A new list with the same items as station_list, where the value of
+	 *  each item is the requested property, as returned by the matching getter.
+	 * @note This costs one opcode per station in the list.
+	 */
+	static ScriptList *GetBulkCargoProperty(ScriptList *station_list, CargoID cargo_id, BulkCargoProperty property);
+
 private:
 	template<bool Tfrom, bool Tvia>
 	static bool IsCargoRequestValid(StationID station_id, StationID from_station_id,
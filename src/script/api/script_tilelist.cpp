@@ -10,6 +10,7 @@
 #include "../../stdafx.h"
 #include "script_tilelist.hpp"
 #include "script_industry.hpp"
+#include "script_controller.hpp"
 #include "../../industry.h"
 #include "../../station_base.h"
 
@@ -21,6 +22,8 @@ void ScriptTileList::AddRectangle(TileIndex t1, TileIndex t2)
 	if (!::IsValidTile(t2)) return;
 
 	TileArea ta(t1, t2);
+	/* Charge one opcode per 16 tiles */
+	ScriptController::DecreaseOps((int)(ta.w * ta.h / 16));
 	TILE_AREA_LOOP(t, ta) this->AddItem(t);
 }
 
@@ -37,6 +40,8 @@ void ScriptTileList::RemoveRectangle(TileIndex t1, TileIndex t2)
 	if (!::IsValidTile(t2)) return;
 
 	TileArea ta(t1, t2);
+	/* Charge one opcode per 16 tiles */
+	ScriptController::DecreaseOps((int)(ta.w * ta.h / 16));
 	TILE_AREA_LOOP(t, ta) this->RemoveItem(t);
 }
 
@@ -389,3 +389,49 @@
 
 	return (ScriptTown::RoadLayout)((TownLayout)::Town::Get(town_id)->layout);
 }
+
+/* static */ ScriptList *ScriptTown::GetBulkProperty(ScriptList *town_list, BulkProperty property)
+{
+	if (town_list == nullptr) return nullptr;
+
+	ScriptController::DecreaseOps((int)town_list->items.size());
+
+	ScriptList *result = new ScriptList();
+	for (const auto &it : town_list->items) {
+		const TownID town_id = (TownID)it.first;
+		int64 value;
+		switch (property) {
+			case BP_LOCATION:      value = GetLocation(town_id); break;
+			case BP_POPULATION:    value = GetPopulation(town_id); break;
+			case BP_HOUSE_COUNT:   value = GetHouseCount(town_id); break;
+			case BP_GROWTH_RATE:   value = GetGrowthRate(town_id); break;
+			case BP_IS_CITY:       value = IsCity(town_id) ? 1 : 0; break;
+			case BP_HAS_STATUE:    value = HasStatue(town_id) ? 1 : 0; break;
+			case BP_ALLOWED_NOISE: value = GetAllowedNoise(town_id); break;
+			default:               value = -1; break;
+		}
+		result->AddItem(it.first, value);
+	}
+	return result;
+}
+
+/* static */ ScriptList *ScriptTown::GetBulkCargoProperty(ScriptList *town_list, CargoID cargo_id, BulkCargoProperty property)
+{
+	if (town_list == nullptr || !ScriptCargo::IsValidCargo(cargo_id)) return nullptr;
+
+	ScriptController::DecreaseOps((int)town_list->items.size());
+
+	ScriptList *result = new ScriptList();
+	for (const auto &it : town_list->items) {
+		const TownID town_id = (TownID)it.first;
+		int64 value;
+		switch (property) {
+			case BCP_LAST_MONTH_PRODUCTION:             value = GetLastMonthProduction(town_id, cargo_id); break;
+			case BCP_LAST_MONTH_SUPPLIED:               value = GetLastMonthSupplied(town_id, cargo_id); break;
+			case BCP_LAST_MONTH_TRANSPORTED_PERCENTAGE: value = GetLastMonthTransportedPercentage(town_id, cargo_id); break;
+			default:                                    value = -1; break;
+		}
+		result->AddItem(it.first, value);
+	}
+	return result;
+}
@@ -12,6 +12,7 @@
 
 #include "script_cargo.hpp"
 #include "script_company.hpp"
+#include "script_list.hpp"
 #include "../../town_type.h"
 
 /**
@@ -461,6 +462,56 @@ public:
 	 * @return The RoadLayout for the town.
 	 */
 	static RoadLayout GetRoadLayout(TownID town_id);
+
+	/**
+	 * Town properties which can be queried for a whole list of towns at once.
+	 */
+	enum BulkProperty {
+		BP_LOCATION,      ///< See GetLocation.
+		BP_POPULATION,    ///< See GetPopulation.
+		BP_HOUSE_COUNT,   ///< See GetHouseCount.
+		BP_GROWTH_RATE,   ///< See GetGrowthRate.
+		BP_IS_CITY,       ///< See IsCity.
+		BP_HAS_STATUE,    ///< See HasStatue.
+		BP_ALLOWED_NOISE, ///< See GetAllowedNoise.
+	};
+
+	/**
+	 * Per-cargo town properties which can be queried for a whole list of towns at once.
+	 */
+	enum BulkCargoProperty {
+		BCP_LAST_MONTH_PRODUCTION,             ///< See GetLastMonthProduction.
+		BCP_LAST_MONTH_SUPPLIED,               ///< See GetLastMonthSupplied.
+		BCP_LAST_MONTH_TRANSPORTED_PERCENTAGE, ///< See GetLastMonthTransportedPercentage.
+	};
+
+	/**
+	 * Get a property of all towns in a list in one call.
+	 * This is equivalent to valuating a copy of the list with the matching
+	 *  getter, but is considerably cheaper for large lists.
+	 * @param town_list The list of towns, for example a ScriptTownList.
+	 * @param property The property to get.
+	 * @pre town_list != null.
+	 * @return A new list with the same items as town_list, where the value of
+	 *  each item is the requested property, as returned by the matching getter.
+	 * @note This costs one opcode per town in the list.
+	 */
+	static ScriptList *GetBulkProperty(ScriptList *town_list, BulkProperty property);
+
+	/**
+	 * Get a per-cargo property of all towns in a list in one call.
+	 * This is equivalent to valuating a copy of the list with the matching
+	 *  getter, but is considerably cheaper for large lists.
+	 * @param town_list The list of towns, for example a ScriptTownList.
+	 * @param cargo_id The cargo to get the property for.
+	 * @param property The property to get.
+	 * @pre town_list != null.
+	 * @pre ScriptCargo::IsValidCargo(cargo_id).
+	 * @return A new list with the same items as town_list, where the value of
+	 *  each item is the requested property, as returned by the matching getter.
+	 * @note This costs one opcode per town in the list.
+	 */
+	static ScriptList *GetBulkCargoProperty(ScriptList *town_list, CargoID cargo_id, BulkCargoProperty property);
 };
 
 #endif /* SCRIPT_TOWN_HPP */
@@ -12,6 +12,7 @@
 #include "script_cargo.hpp"
 #include "script_gamesettings.hpp"
 #include "script_group.hpp"
+#include "script_controller.hpp"
 #include "../script_instance.hpp"
 #include "../../string_func.h"
 #include "../../strings_func.h"
@@ -477,3 +478,36 @@
 			return 0;
 	}
 }
+
+/* static */ ScriptList *ScriptVehicle::GetBulkProperty(ScriptList *vehicle_list, BulkProperty property)
+{
+	if (vehicle_list == nullptr) return nullptr;
+
+	ScriptController::DecreaseOps((int)vehicle_list->items.size());
+
+	ScriptList *result = new ScriptList();
+	for (const auto &it : vehicle_list->items) {
+		const VehicleID vehicle_id = (VehicleID)it.first;
+		int64 value;
+		switch (property) {
+			case BP_LOCATION:         value = GetLocation(vehicle_id); break;
+			case BP_ENGINE_TYPE:      value = GetEngineType(vehicle_id); break;
+			case BP_UNIT_NUMBER:      value = GetUnitNumber(vehicle_id); break;
+			case BP_AGE:              value = GetAge(vehicle_id); break;
+			case BP_MAX_AGE:          value = GetMaxAge(vehicle_id); break;
+			case BP_AGE_LEFT:         value = GetAgeLeft(vehicle_id); break;
+			case BP_CURRENT_SPEED:    value = GetCurrentSpeed(vehicle_id); break;
+			case BP_STATE:            value = GetState(vehicle_id); break;
+			case BP_RUNNING_COST:     value = GetRunningCost(vehicle_id); break;
+			case BP_PROFIT_THIS_YEAR: value = GetProfitThisYear(vehicle_id); break;
+			case BP_PROFIT_LAST_YEAR: value = GetProfitLastYear(vehicle_id); break;
+			case BP_CURRENT_VALUE:    value = GetCurrentValue(vehicle_id); break;
+			case BP_VEHICLE_TYPE:     value = GetVehicleType(vehicle_id); break;
+			case BP_RELIABILITY:      value = GetReliability(vehicle_id); break;
+			case BP_GROUP_ID:         value = GetGroupID(vehicle_id); break;
+			default:                  value = -1; break;
+		}
+		result->AddItem(it.first, value);
+	}
+	return result;
+}
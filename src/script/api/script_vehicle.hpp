@@ -11,6 +11,7 @@
 #define SCRIPT_VEHICLE_HPP
 
 #include "script_road.hpp"
+#include "script_list.hpp"
 
 /**
  * Class that handles all vehicle related functions.
@@ -599,6 +600,41 @@ public:
 	 */
 	static uint GetMaximumOrderDistance(VehicleID vehicle_id);
 
+	/**
+	 * Vehicle properties which can be queried for a whole list of vehicles at once.
+	 */
+	enum BulkProperty {
+		BP_LOCATION,         ///< See GetLocation.
+		BP_ENGINE_TYPE,      ///< See GetEngineType.
+		BP_UNIT_NUMBER,      ///< See GetUnitNumber.
+		BP_AGE,              ///< See GetAge.
+		BP_MAX_AGE,          ///< See GetMaxAge.
+		BP_AGE_LEFT,         ///< See GetAgeLeft.
+		BP_CURRENT_SPEED,    ///< See GetCurrentSpeed.
+		BP_STATE,            ///< See GetState.
+		BP_RUNNING_COST,     ///< See GetRunningCost.
+		BP_PROFIT_THIS_YEAR, ///< See GetProfitThisYear.
+		BP_PROFIT_LAST_YEAR, ///< See GetProfitLastYear.
+		BP_CURRENT_VALUE,    ///< See GetCurrentValue.
+		BP_VEHICLE_TYPE,     ///< See GetVehicleType.
+		BP_RELIABILITY,      ///< See GetReliability.
+		BP_GROUP_ID,         ///< See GetGroupID.
+	};
+
+	/**
+	 * Get a property of all vehicles in a list in one call.
+	 * This is equivalent to valuating a copy of the list with the matching
+	 *  getter, but is considerably cheaper for large lists.
+	 * @param vehicle_list The list of vehicles, for example a ScriptVehicleList.
+	 * @param property The property to get.
+	 * @pre vehicle_list != null.
+	 * @return A new list with the same items as vehicle_list, where the value of
+	 *  each item is the requested property, as returned by the matching getter.
+	 *  Invalid vehicles get the same value as the getter returns for them.
+	 * @note This costs one opcode per vehicle in the list.
+	 */
+	static ScriptList *GetBulkProperty(ScriptList *vehicle_list, BulkProperty property);
+
 private:
 	/**
 	 * Internal function used by BuildVehicle(WithRefit).
@@ -12,14 +12,23 @@
 #include "script_group.hpp"
 #include "script_map.hpp"
 #include "script_station.hpp"
+#include "script_controller.hpp"
 #include "../../depot_map.h"
 #include "../../vehicle_base.h"
 #include "../../train.h"
 
 #include "../../safeguards.h"
 
+/** Charge the active script for a scan of the whole vehicle pool, one opcode per 16 vehicles. */
+static void ChargeVehiclePoolScan()
+{
+	ScriptController::DecreaseOps((int)(::Vehicle::GetNumItems() / 16));
+}
+
 ScriptVehicleList::ScriptVehicleList()
 {
+	ChargeVehiclePoolScan();
+
 	for (const Vehicle *v : Vehicle::Iterate()) {
 		if ((v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && (v->IsPrimaryVehicle() || (v->type == VEH_TRAIN && ::Train::From(v)->IsFreeWagon()))) this->AddItem(v->index);
 	}
@@ -29,6 +38,7 @@ ScriptVehicleList_Station::ScriptVehicleList_Station(StationID station_id)
 {
 	if (!ScriptBaseStation::IsValidBaseStation(station_id)) return;
 
+	ChargeVehiclePoolScan();
 	for (const Vehicle *v : Vehicle::Iterate()) {
 		if ((v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && v->IsPrimaryVehicle()) {
 			for (const Order *order : v->Orders()) {
@@ -77,6 +87,7 @@ ScriptVehicleList_Depot::ScriptVehicleList_Depot(TileIndex tile)
 			return;
 	}
 
+	ChargeVehiclePoolScan();
 	for (const Vehicle *v : Vehicle::Iterate()) {
 		if ((v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && v->IsPrimaryVehicle() && v->type == type) {
 			for (const Order *order : v->Orders()) {
@@ -102,6 +113,7 @@ ScriptVehicleList_Group::ScriptVehicleList_Group(GroupID group_id)
 {
 	if (!ScriptGroup::IsValidGroup((ScriptGroup::GroupID)group_id)) return;
 
+	ChargeVehiclePoolScan();
 	for (const Vehicle *v : Vehicle::Iterate()) {
 		if (v->owner == ScriptObject::GetCompany() && v->IsPrimaryVehicle()) {
 			if (v->group_id == group_id) this->AddItem(v->index);
@@ -113,6 +125,7 @@ ScriptVehicleList_DefaultGroup::ScriptVehicleList_DefaultGroup(ScriptVehicle::Ve
 {
 	if (vehicle_type < ScriptVehicle::VT_RAIL || vehicle_type > ScriptVehicle::VT_AIR) return;
 
+	ChargeVehiclePoolScan();
 	for (const Vehicle *v : Vehicle::Iterate()) {
 		if (v->owner == ScriptObject::GetCompany() && v->IsPrimaryVehicle()) {
 			if (v->type == (::VehicleType)vehicle_type && v->group_id == ScriptGroup::GROUP_DEFAULT) this->AddItem(v->index);
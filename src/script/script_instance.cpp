@@ -25,6 +25,7 @@
 
 #include "../company_base.h"
 #include "../company_func.h"
+#include "../date_func.h"
 #include "../fileio_func.h"
 
 #include "../safeguards.h"
@@ -60,7 +61,12 @@ ScriptInstance::ScriptInstance(const char *APIName) :
 	is_paused(false),
 	in_shutdown(false),
 	callback(nullptr),
-	APIName(APIName)
+	APIName(APIName),
+	ops_used_last(0),
+	ops_used_average(0),
+	ops_demand_average(0),
+	budget_weight(0),
+	budget_generation(0)
 {
 	this->storage = new ScriptStorage();
 	this->engine  = new Squirrel(APIName);
@@ -160,6 +166,7 @@ ScriptInstance::~ScriptInstance()
 {
 	ScriptObject::ActiveInstance active(this);
 	this->in_shutdown = true;
+	this->ReleaseOpcodeBudget();
 
 	if (instance != nullptr) this->engine->ReleaseObject(this->instance);
 	if (engine != nullptr) delete this->engine;
@@ -179,6 +186,7 @@ void ScriptInstance::Died()
 	DEBUG(script, 0, "The script died unexpectedly.");
 	this->is_dead = true;
 	this->in_shutdown = true;
+	this->ReleaseOpcodeBudget();
 
 	this->last_allocated_memory = this->GetAllocatedMemory(); // Update cache
 
@@ -189,6 +197,68 @@ void ScriptInstance::Died()
 	this->engine = nullptr;
 }
 
+uint32 ScriptInstance::tick_budget_generation = 0;
+uint32 ScriptInstance::tick_budget_remaining = 0;
+uint64 ScriptInstance::tick_budget_pending_weight = 0;
+
+/** Minimum number of opcodes a script may always use per run, such that it can make progress when the per-tick budget is exhausted. */
+static const int MIN_OPS_PER_RUN = 500;
+
+/* static */ void ScriptInstance::BeginOpcodeBudget()
+{
+	ScriptInstance::tick_budget_generation++;
+	ScriptInstance::tick_budget_remaining = _settings_game.script.script_max_opcodes_per_tick;
+	ScriptInstance::tick_budget_pending_weight = 0;
+}
+
+void ScriptInstance::ScheduleOpcodeBudget()
+{
+	if (_settings_game.script.script_max_opcodes_per_tick == 0) return;
+
+	/* Only the scripts which get to run the VM in GameLoop have a claim. */
+	if (this->IsDead() || this->is_paused || this->engine->HasScriptCrashed()) return;
+	if (this->suspend < 0 || this->suspend > 1) return;
+
+	this->ReleaseOpcodeBudget();
+	this->budget_weight = Clamp<uint32>(this->ops_demand_average, MIN_OPS_PER_RUN, std::max<uint32>(MIN_OPS_PER_RUN, _settings_game.script.script_max_opcode_till_suspend));
+	this->budget_generation = ScriptInstance::tick_budget_generation;
+	ScriptInstance::tick_budget_pending_weight += this->budget_weight;
+}
+
+void ScriptInstance::ReleaseOpcodeBudget()
+{
+	if (!this->HasOpcodeBudgetClaim()) return;
+	ScriptInstance::tick_budget_pending_weight -= this->budget_weight;
+	this->budget_weight = 0;
+}
+
+int ScriptInstance::GetOpcodeAllowance()
+{
+	const int max_ops = _settings_game.script.script_max_opcode_till_suspend;
+	if (_settings_game.script.script_max_opcodes_per_tick == 0) return max_ops;
+
+	/* Share the remaining budget between this and the scripts which have yet to run in this tick, in proportion to their demand.
+	 * Budget left unused by an earlier script is available to the later ones. */
+	uint64 share = ScriptInstance::tick_budget_remaining;
+	if (this->HasOpcodeBudgetClaim()) share = share * this->budget_weight / ScriptInstance::tick_budget_pending_weight;
+	return Clamp<int>((int)std::min<uint64>(share, INT_MAX), std::min(MIN_OPS_PER_RUN, max_ops), max_ops);
+}
+
+void ScriptInstance::RecordOpcodesUsed(int64 used, bool exhausted)
+{
+	this->ops_used_last = (uint32)Clamp<int64>(used, 0, UINT32_MAX);
+	this->ops_used_average = (uint32)(((uint64)this->ops_used_average * 7 + this->ops_used_last) / 8);
+
+	/* A run which was cut short wanted at least a full run. */
+	const uint32 demand = exhausted ? std::max<uint32>(this->ops_used_last, _settings_game.script.script_max_opcode_till_suspend) : this->ops_used_last;
+	this->ops_demand_average = (uint32)(((uint64)this->ops_demand_average * 7 + demand) / 8);
+
+	if (this->HasOpcodeBudgetClaim()) {
+		ScriptInstance::tick_budget_remaining -= std::min(ScriptInstance::tick_budget_remaining, this->ops_used_last);
+		this->ReleaseOpcodeBudget();
+	}
+}
+
 void ScriptInstance::GameLoop()
 {
 	ScriptObject::ActiveInstance active(this);
@@ -219,6 +289,7 @@ void ScriptInstance::GameLoop()
 		} catch (Script_Suspend &e) {
 			this->suspend  = e.GetSuspendTime();
 			this->callback = e.GetSuspendCallback();
+			this->ReleaseOpcodeBudget();
 
 			return;
 		}
@@ -228,6 +299,7 @@ void ScriptInstance::GameLoop()
 	this->callback = nullptr;
 
 	if (!this->is_started) {
+		const int allowance = this->GetOpcodeAllowance();
 		try {
 			ScriptObject::SetAllowDoCommand(false);
 			/* Run the constructor if it exists. Don't allow any DoCommands in it. */
@@ -245,8 +317,11 @@ void ScriptInstance::GameLoop()
 			}
 			ScriptObject::SetAllowDoCommand(true);
 			/* Start the script by calling Start() */
-			if (!this->engine->CallMethod(*this->instance, "Start",  _settings_game.script.script_max_opcode_till_suspend) || !this->engine->IsSuspended()) this->Died();
+			const bool ok = this->engine->CallMethod(*this->instance, "Start", allowance) && this->engine->IsSuspended();
+			this->RecordOpcodesUsed((int64)allowance - this->engine->GetOpsTillSuspend(), this->engine->GetOpsTillSuspend() <= 0);
+			if (!ok) this->Died();
 		} catch (Script_Suspend &e) {
+			this->RecordOpcodesUsed((int64)allowance - this->engine->GetOpsTillSuspend(), false);
 			this->suspend  = e.GetSuspendTime();
 			this->callback = e.GetSuspendCallback();
 		} catch (Script_FatalError &e) {
@@ -265,9 +340,14 @@ void ScriptInstance::GameLoop()
 	}
 
 	/* Continue the VM */
+	const int allowance = this->GetOpcodeAllowance();
 	try {
-		if (!this->engine->Resume(_settings_game.script.script_max_opcode_till_suspend)) this->Died();
+		const bool ok = this->engine->Resume(allowance);
+		this->RecordOpcodesUsed(this->engine->GetLastResumeOpsUsed(), this->engine->GetOpsTillSuspend() <= 0);
+		if (!ok) this->Died();
 	} catch (Script_Suspend &e) {
+		/* The suspension left the VM before Resume could count the opcodes used. */
+		this->RecordOpcodesUsed((int64)allowance - this->engine->GetOpsTillSuspend(), false);
 		this->suspend  = e.GetSuspendTime();
 		this->callback = e.GetSuspendCallback();
 	} catch (Script_FatalError &e) {
@@ -754,6 +834,15 @@ size_t ScriptInstance::GetAllocatedMemory() const
 	return this->engine->GetAllocatedMemory();
 }
 
+void ScriptInstance::DumpAllocatorStats(std::function<void(const char *)> print) const
+{
+	if (this->engine == nullptr) {
+		print("Script is not running");
+		return;
+	}
+	this->engine->DumpAllocatorStats(print);
+}
+
 void ScriptInstance::SetMemoryAllocationLimit(size_t limit) const
 {
 	if (this->engine != nullptr) this->engine->SetMemoryAllocationLimit(limit);
@@ -11,6 +11,7 @@
 #define SCRIPT_INSTANCE_HPP
 
 #include <squirrel.h>
+#include <functional>
 #include "script_suspend.hpp"
 
 #include "../command_type.h"
@@ -203,8 +204,35 @@ public:
 
 	size_t GetAllocatedMemory() const;
 
+	/**
+	 * Output statistics of the memory allocator of this script.
+	 * @param print Function to output each line with.
+	 */
+	void DumpAllocatorStats(std::function<void(const char *)> print) const;
+
 	void SetMemoryAllocationLimit(size_t limit) const;
 
+	/**
+	 * Get the average number of opcodes used by this script per run, including API call charges.
+	 */
+	inline uint32 GetAverageOpcodesUsed() const { return this->ops_used_average; }
+
+	/**
+	 * Get the number of opcodes used by this script in its most recent run, including API call charges.
+	 */
+	inline uint32 GetLastOpcodesUsed() const { return this->ops_used_last; }
+
+	/**
+	 * Start the opcode budget shared by the scripts which run in this tick.
+	 * The scripts which are going to run must then be added by ScheduleOpcodeBudget.
+	 */
+	static void BeginOpcodeBudget();
+
+	/**
+	 * Claim a share of the opcode budget of this tick, weighted by the measured opcode demand of this script, if it is going to run in this tick.
+	 */
+	void ScheduleOpcodeBudget();
+
 	/**
 	 * Indicate whether this instance is currently being destroyed.
 	 */
@@ -262,6 +290,37 @@ private:
 	Script_SuspendCallbackProc *callback; ///< Callback that should be called in the next tick the script runs.
 	size_t last_allocated_memory;         ///< Last known allocated memory value (for display for crashed scripts)
 	const char *APIName;                  ///< Name of the API used for this squirrel.
+	uint32 ops_used_last;                 ///< Opcodes used in the most recent run.
+	uint32 ops_used_average;              ///< Moving average of opcodes used per run.
+	uint32 ops_demand_average;            ///< Moving average of opcodes wanted per run, which is the full run limit for runs which ran out of opcodes.
+	uint32 budget_weight;                 ///< Weight of the claim of this script on the per-tick budget, 0 when it has no claim.
+	uint32 budget_generation;             ///< Generation of the per-tick budget the claim of this script belongs to.
+
+	static uint32 tick_budget_generation; ///< Generation of the current per-tick opcode budget.
+	static uint32 tick_budget_remaining;  ///< Opcodes remaining in the per-tick budget.
+	static uint64 tick_budget_pending_weight; ///< Total weight of the claims of the scripts which have yet to run in this tick.
+
+	/**
+	 * Get the number of opcodes this script may use in this run, taking into account the budget shared between all scripts per tick.
+	 */
+	int GetOpcodeAllowance();
+
+	/**
+	 * Get whether this script has a claim on the per-tick budget of the current tick.
+	 */
+	inline bool HasOpcodeBudgetClaim() const { return this->budget_weight > 0 && this->budget_generation == ScriptInstance::tick_budget_generation; }
+
+	/**
+	 * Drop the claim of this script on the per-tick budget, if it has one.
+	 */
+	void ReleaseOpcodeBudget();
+
+	/**
+	 * Record the number of opcodes used in this run, and charge them to the per-tick budget.
+	 * @param used The number of opcodes used, including API call charges.
+	 * @param exhausted Whether the run was suspended because it used all of its opcodes.
+	 */
+	void RecordOpcodesUsed(int64 used, bool exhausted);
 
 	/**
 	 * Call the script Load function if it exists and data was loaded
@@ -21,6 +21,8 @@
 
 #include <stdarg.h>
 #include <map>
+#include <vector>
+#include <functional>
 
 /**
  * In the memory allocator for Squirrel we want to directly use malloc/realloc, so when the OS
@@ -36,6 +38,14 @@
 #define SCRIPT_DEBUG_ALLOCATIONS
 */
 
+/**
+ * Memory allocator of a single script instance.
+ * Small allocations, which make up the bulk of the tables, arrays, closures and strings
+ * that scripts create, are served from per size class free lists carved out of large
+ * chunks. Larger allocations are passed on to malloc/realloc directly.
+ * Squirrel always passes the size of an allocation when freeing or reallocating it, so
+ * no per-allocation header is required.
+ */
 struct ScriptAllocator {
 	size_t allocated_size;   ///< Sum of allocated data size
 	size_t allocation_limit; ///< Maximum this allocator may use before allocations fail
@@ -49,6 +59,26 @@ struct ScriptAllocator {
 
 	static const size_t SAFE_LIMIT = 0x8000000; ///< 128 MiB, a safe choice for almost any situation
 
+	static const size_t POOL_GRANULARITY = 16;                                   ///< Size difference between consecutive size classes, also the alignment of pooled allocations
+	static const size_t POOL_MAX_SIZE = 512;                                     ///< Largest allocation served from the pool
+	static const size_t POOL_SIZE_CLASSES = POOL_MAX_SIZE / POOL_GRANULARITY;    ///< Number of size classes
+	static const size_t POOL_CHUNK_SIZE = 0x10000;                               ///< Size of the chunks from which pooled allocations are carved
+
+	/** Free list and statistics of a single size class. */
+	struct PoolSizeClass {
+		void *free_list;        ///< Singly linked list of free slots, the link is stored in the slot itself
+		size_t slots;           ///< Number of slots carved out of the chunks
+		size_t in_use;          ///< Number of slots currently in use
+		uint64 allocations;     ///< Number of allocations served since the allocator was created
+	};
+
+	PoolSizeClass size_classes[POOL_SIZE_CLASSES]; ///< Pool size classes
+	std::vector<void *> pool_chunks;               ///< All chunks, freed together with the allocator
+	char *chunk_pos;                               ///< First unused byte of the current chunk
+	char *chunk_end;                               ///< End of the current chunk
+	size_t large_count;                            ///< Number of live allocations not served from the pool
+	size_t large_size;                             ///< Size of live allocations not served from the pool
+
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 	std::map<void *, size_t> allocations;
 #endif
@@ -97,9 +127,84 @@ struct ScriptAllocator {
 		}
 	}
 
-	void *Malloc(SQUnsignedInteger size)
+	static inline bool IsPooledSize(size_t size)
+	{
+		return size <= POOL_MAX_SIZE;
+	}
+
+	static inline size_t GetSizeClass(size_t size)
 	{
+		return size == 0 ? 0 : (size - 1) / POOL_GRANULARITY;
+	}
+
+	/**
+	 * Allocate a slot from the pool.
+	 * @param size The requested size, at most POOL_MAX_SIZE.
+	 * @return The slot, or nullptr if a new chunk could not be allocated.
+	 */
+	void *PoolAlloc(size_t size)
+	{
+		PoolSizeClass &sc = this->size_classes[GetSizeClass(size)];
+		void *p = sc.free_list;
+		if (p != nullptr) {
+			sc.free_list = *static_cast<void **>(p);
+		} else {
+			const size_t slot_size = (GetSizeClass(size) + 1) * POOL_GRANULARITY;
+			if (this->chunk_pos == nullptr || (size_t)(this->chunk_end - this->chunk_pos) < slot_size) {
+				char *chunk = static_cast<char *>(malloc(POOL_CHUNK_SIZE));
+				if (chunk == nullptr) return nullptr;
+				this->pool_chunks.push_back(chunk);
+				this->chunk_pos = chunk;
+				this->chunk_end = chunk + POOL_CHUNK_SIZE;
+			}
+			p = this->chunk_pos;
+			this->chunk_pos += slot_size;
+			sc.slots++;
+		}
+		sc.in_use++;
+		sc.allocations++;
+		return p;
+	}
+
+	/**
+	 * Return a slot to the pool.
+	 * @param p The slot.
+	 * @param size The size the slot was allocated with.
+	 */
+	void PoolFree(void *p, size_t size)
+	{
+		PoolSizeClass &sc = this->size_classes[GetSizeClass(size)];
+		*static_cast<void **>(p) = sc.free_list;
+		sc.free_list = p;
+		sc.in_use--;
+	}
+
+	void *RawAlloc(size_t size)
+	{
+		if (IsPooledSize(size)) return this->PoolAlloc(size);
+
 		void *p = malloc(size);
+		if (p != nullptr) {
+			this->large_count++;
+			this->large_size += size;
+		}
+		return p;
+	}
+
+	void RawFree(void *p, size_t size)
+	{
+		if (IsPooledSize(size)) {
+			this->PoolFree(p, size);
+		} else {
+			free(p);
+			this->large_count--;
+			this->large_size -= size;
+		}
+	}
+
+	void *Malloc(SQUnsignedInteger size)
+	{
+		void *p = this->RawAlloc(size);
 		this->allocated_size += size;
 
 		this->CheckAllocation(size, p);
@@ -128,12 +233,25 @@ struct ScriptAllocator {
 		this->allocations.erase(p);
 #endif
 
-		void *new_p = realloc(p, size);
+		void *new_p;
+		if (!IsPooledSize(oldsize) && !IsPooledSize(size)) {
+			new_p = realloc(p, size);
+			if (new_p != nullptr) this->large_size += size - oldsize;
+		} else if (IsPooledSize(oldsize) && IsPooledSize(size) && GetSizeClass(oldsize) == GetSizeClass(size)) {
+			/* The slot is large enough already */
+			new_p = p;
+		} else {
+			new_p = this->RawAlloc(size);
+			if (new_p != nullptr) {
+				memcpy(new_p, p, std::min<size_t>(oldsize, size));
+				this->RawFree(p, oldsize);
+			}
+		}
 
 		this->allocated_size -= oldsize;
 		this->allocated_size += size;
 
-		this->CheckAllocation(size, p);
+		this->CheckAllocation(size, new_p);
 
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 		assert(new_p != nullptr);
@@ -147,7 +265,7 @@ struct ScriptAllocator {
 	void Free(void *p, SQUnsignedInteger size)
 	{
 		if (p == nullptr) return;
-		free(p);
+		this->RawFree(p, size);
 		this->allocated_size -= size;
 
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
@@ -156,12 +274,56 @@ struct ScriptAllocator {
 #endif
 	}
 
+	/**
+	 * Output allocator statistics.
+	 * @param print Function to output each line with.
+	 */
+	void DumpStats(std::function<void(const char *)> print) const
+	{
+		char buffer[256];
+
+		size_t pool_used = 0;
+		size_t pool_free = 0;
+		for (size_t i = 0; i < POOL_SIZE_CLASSES; i++) {
+			const PoolSizeClass &sc = this->size_classes[i];
+			const size_t slot_size = (i + 1) * POOL_GRANULARITY;
+			pool_used += sc.in_use * slot_size;
+			pool_free += (sc.slots - sc.in_use) * slot_size;
+		}
+		const size_t pool_reserved = this->pool_chunks.size() * POOL_CHUNK_SIZE;
+
+		seprintf(buffer, lastof(buffer), "Allocated: " PRINTF_SIZE " bytes, limit: " PRINTF_SIZE " bytes", this->allocated_size, this->allocation_limit);
+		print(buffer);
+		seprintf(buffer, lastof(buffer), "Pool: " PRINTF_SIZE " chunks, " PRINTF_SIZE " bytes reserved, " PRINTF_SIZE " bytes in use, " PRINTF_SIZE " bytes in free slots, " PRINTF_SIZE " bytes unused in chunks",
+				this->pool_chunks.size(), pool_reserved, pool_used, pool_free, pool_reserved - pool_used - pool_free);
+		print(buffer);
+		if (pool_reserved > 0) {
+			seprintf(buffer, lastof(buffer), "Pool fragmentation: %u%% of reserved memory in free slots or unused", (uint)(100 * (pool_reserved - pool_used) / pool_reserved));
+			print(buffer);
+		}
+		seprintf(buffer, lastof(buffer), "Large: " PRINTF_SIZE " allocations, " PRINTF_SIZE " bytes", this->large_count, this->large_size);
+		print(buffer);
+
+		for (size_t i = 0; i < POOL_SIZE_CLASSES; i++) {
+			const PoolSizeClass &sc = this->size_classes[i];
+			if (sc.slots == 0) continue;
+			seprintf(buffer, lastof(buffer), "  %4u bytes: " PRINTF_SIZE " in use, " PRINTF_SIZE " free, " OTTD_PRINTF64U " allocations",
+					(uint)((i + 1) * POOL_GRANULARITY), sc.in_use, sc.slots - sc.in_use, sc.allocations);
+			print(buffer);
+		}
+	}
+
 	ScriptAllocator()
 	{
 		this->allocated_size = 0;
 		this->allocation_limit = static_cast<size_t>(_settings_game.script.script_max_memory_megabytes) << 20;
 		if (this->allocation_limit == 0) this->allocation_limit = SAFE_LIMIT; // in case the setting is somehow zero
 		this->error_thrown = false;
+		memset(this->size_classes, 0, sizeof(this->size_classes));
+		this->chunk_pos = nullptr;
+		this->chunk_end = nullptr;
+		this->large_count = 0;
+		this->large_size = 0;
 	}
 
 	~ScriptAllocator()
@@ -169,6 +331,10 @@ struct ScriptAllocator {
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 		assert(this->allocations.size() == 0);
 #endif
+		/* Everything allocated from the pool goes away in one go */
+		for (void *chunk : this->pool_chunks) {
+			free(chunk);
+		}
 	}
 };
 
@@ -195,6 +361,12 @@ size_t Squirrel::GetAllocatedMemory() const noexcept
 	return this->allocator->allocated_size;
 }
 
+void Squirrel::DumpAllocatorStats(std::function<void(const char *)> print) const
+{
+	assert(this->allocator != nullptr);
+	this->allocator->DumpStats(print);
+}
+
 void Squirrel::SetMemoryAllocationLimit(size_t limit) noexcept
 {
 	if (this->allocator != nullptr) {
@@ -387,6 +559,7 @@ bool Squirrel::Resume(int suspend)
 
 	/* Did we use more operations than we should have in the
 	 * previous tick? If so, subtract that from the current run. */
+	this->last_resume_ops = 0;
 	if (this->overdrawn_ops > 0 && suspend > 0) {
 		this->overdrawn_ops -= suspend;
 		/* Do we need to wait even more? */
@@ -398,6 +571,7 @@ bool Squirrel::Resume(int suspend)
 
 	this->crashed = !sq_resumecatch(this->vm, suspend);
 	this->overdrawn_ops = -this->vm->_ops_till_suspend;
+	this->last_resume_ops = suspend - this->vm->_ops_till_suspend;
 	this->allocator->CheckLimit();
 	return this->vm->_suspended != 0;
 }
@@ -547,6 +721,7 @@ void Squirrel::Initialize()
 	this->print_func = nullptr;
 	this->crashed = false;
 	this->overdrawn_ops = 0;
+	this->last_resume_ops = 0;
 	this->vm = sq_open(1024);
 
 	/* Handle compile-errors ourself, so we can display it nicely */
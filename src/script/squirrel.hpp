@@ -11,6 +11,7 @@
 #define SQUIRREL_HPP
 
 #include <squirrel.h>
+#include <functional>
 
 /** The type of script we're working with, i.e. for who is it? */
 enum ScriptType {
@@ -31,6 +32,7 @@ private:
 	SQPrintFunc *print_func; ///< Points to either nullptr, or a custom print handler
 	bool crashed;            ///< True if the squirrel script made an error.
 	int overdrawn_ops;       ///< The amount of operations we have overdrawn.
+	int last_resume_ops;     ///< The amount of operations used by the last call to Resume, including overdrawn operations.
 	const char *APIName;     ///< Name of the API used for this squirrel.
 	std::unique_ptr<ScriptAllocator> allocator; ///< Allocator object used by this script.
 
@@ -271,6 +273,11 @@ public:
 	 */
 	SQInteger GetOpsTillSuspend();
 
+	/**
+	 * How many operations were used by the last call to Resume?
+	 */
+	int GetLastResumeOpsUsed() const { return this->last_resume_ops; }
+
 	/**
 	 * Completely reset the engine; start from scratch.
 	 */
@@ -281,6 +288,12 @@ public:
 	 */
 	size_t GetAllocatedMemory() const noexcept;
 
+	/**
+	 * Output statistics of the memory allocator of this VM.
+	 * @param print Function to output each line with.
+	 */
+	void DumpAllocatorStats(std::function<void(const char *)> print) const;
+
 	void SetMemoryAllocationLimit(size_t limit) noexcept;
 };
 
@@ -317,6 +317,7 @@ struct NetworkSettings {
 	uint16 sync_freq;                                     ///< how often do we check whether we are still in-sync
 	uint8  frame_freq;                                    ///< how often do we send commands to the clients
 	uint16 commands_per_frame;                            ///< how many commands may be sent each frame_freq frames?
+	uint8  max_frame_batch;                               ///< up to how many ticks worth of frames and commands may be bundled for clients with a high latency
 	uint16 max_commands_in_queue;                         ///< how many commands may there be in the incoming queue before dropping the connection?
 	uint16 bytes_per_frame;                               ///< how many bytes may, over a long period, be received per frame?
 	uint16 bytes_per_frame_burst;                         ///< how many bytes may, over a short period, be received?
@@ -326,6 +327,9 @@ struct NetworkSettings {
 	uint16 max_password_time;                             ///< maximum amount of time, in game ticks, a client may take to enter the password
 	uint16 max_lag_time;                                  ///< maximum amount of time, in game ticks, a client may be lagging behind the server
 	bool   pause_on_join;                                 ///< pause the game when people join
+	bool   desync_state_hash;                             ///< (server) compute hierarchical state hashes at sync frames, and request them from clients after a desync to locate its source
+	uint16 slow_command_threshold;                        ///< commands taking at least this many milliseconds are logged as slow, 0 to disable
+	uint16 desync_test_interval;                          ///< number of ticks in a window of the desync self-test of a dedicated server, 0 to disable
 	uint16 server_port;                                   ///< port the server listens on
 	uint16 server_admin_port;                             ///< port the server listens on for the admin network
 	bool   server_admin_chat;                             ///< allow private chat for the server to be distributed to the admin network
@@ -453,6 +457,7 @@ struct AISettings {
 struct ScriptSettings {
 	uint8  settings_profile;                 ///< difficulty profile to set initial settings of scripts, esp. random AIs
 	uint32 script_max_opcode_till_suspend;   ///< max opcode calls till scripts will suspend
+	uint32 script_max_opcodes_per_tick;      ///< max opcode calls shared between all scripts per game tick, 0 = no limit
 	uint32 script_max_memory_megabytes;      ///< limit on memory a single script instance may have allocated
 };
 
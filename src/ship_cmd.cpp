@@ -15,6 +15,7 @@
 #include "company_func.h"
 #include "pathfinder/npf/npf_func.h"
 #include "depot_base.h"
+#include "depot_kdtree.h"
 #include "station_base.h"
 #include "newgrf_engine.h"
 #include "pathfinder/yapf/yapf.h"
@@ -154,27 +155,18 @@ void Ship::GetImage(Direction direction, EngineImageType image_type, VehicleSpri
 
 static const Depot *FindClosestShipDepot(const Vehicle *v, uint max_distance)
 {
-	/* Find the closest depot */
-	const Depot *best_depot = nullptr;
 	/* If we don't have a maximum distance, i.e. distance = 0,
-	 * we want to find any depot so the best distance of no
-	 * depot must be more than any correct distance. On the
-	 * other hand if we have set a maximum distance, any depot
-	 * further away than max_distance can safely be ignored. */
-	uint best_dist = max_distance == 0 ? UINT_MAX : max_distance + 1;
-
-	for (const Depot *depot : Depot::Iterate()) {
-		TileIndex tile = depot->xy;
-		if (IsShipDepotTile(tile) && IsInfraTileUsageAllowed(VEH_SHIP, v->owner, tile)) {
-			uint dist = DistanceManhattan(tile, v->tile);
-			if (dist < best_dist) {
-				best_dist = dist;
-				best_depot = depot;
-			}
-		}
-	}
+	 * we want to find any depot. On the other hand if we have
+	 * set a maximum distance, any depot further away than
+	 * max_distance can safely be ignored.
+	 * Of depots at the same distance the one with the lowest index is chosen. */
+	int limit = (max_distance == 0) ? INT_MAX : (int)std::min<uint>(max_distance, INT_MAX);
+
+	DepotID best_depot = _ship_depot_kdtree.FindNearestFiltered(TileX(v->tile), TileY(v->tile), [&](DepotID id) {
+		return IsInfraTileUsageAllowed(VEH_SHIP, v->owner, Depot::Get(id)->xy);
+	}, INVALID_DEPOT, limit);
 
-	return best_depot;
+	return (best_depot == INVALID_DEPOT) ? nullptr : Depot::Get(best_depot);
 }
 
 static void CheckIfShipNeedsService(Vehicle *v)
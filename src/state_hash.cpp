@@ -0,0 +1,382 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file state_hash.cpp Hierarchical hashes of the game state, for locating the source of desyncs. */
+
+#include "stdafx.h"
+#include "state_hash.h"
+#include "date_func.h"
+#include "map_func.h"
+#include "vehicle_base.h"
+#include "station_base.h"
+#include "cargopacket.h"
+#include "company_base.h"
+#include "town.h"
+#include "industry.h"
+#include "string_func.h"
+
+#include "safeguards.h"
+
+/** Simple 64 bit hash accumulator, order dependent. */
+struct StateHasher {
+	uint64 state = 0xCBF29CE484222325ULL;
+
+	inline void Add(uint64 value)
+	{
+		this->state = (this->state ^ value) * 0x100000001B3ULL;
+		this->state ^= this->state >> 29;
+	}
+};
+
+static const char * const _state_hash_subsystem_names[SHS_END] = {
+	"vehicles",
+	"stations",
+	"cargo packets",
+	"companies",
+	"towns",
+	"industries",
+	"tiles",
+};
+
+/**
+ * Get the name of a state hash subsystem.
+ * @param subsystem The subsystem.
+ * @return The name.
+ */
+const char *GetStateHashSubsystemName(StateHashSubsystem subsystem)
+{
+	return subsystem < SHS_END ? _state_hash_subsystem_names[subsystem] : "unknown";
+}
+
+static uint64 HashVehicle(const Vehicle *v)
+{
+	StateHasher h;
+	h.Add(v->index);
+	h.Add(((uint64)v->type << 32) | ((uint64)v->subtype << 24) | ((uint64)v->owner << 16) | v->engine_type);
+	h.Add(v->tile);
+	h.Add(((uint64)(uint32)v->x_pos << 32) | (uint32)v->y_pos);
+	h.Add(((uint64)(uint32)v->z_pos << 32) | ((uint64)v->direction << 24) | ((uint64)v->vehstatus << 16) | ((uint64)v->progress << 8) | v->subspeed);
+	h.Add(((uint64)v->cur_speed << 32) | ((uint64)v->reliability << 16) | ((uint64)v->breakdown_ctr << 8) | v->cur_real_order_index);
+	h.Add((uint64)(int64)v->profit_this_year);
+	h.Add(v->cargo.TotalCount());
+	return h.state;
+}
+
+static uint64 HashStation(const Station *st)
+{
+	StateHasher h;
+	h.Add(st->index);
+	h.Add(((uint64)st->xy << 32) | ((uint64)st->owner << 8) | st->facilities);
+	for (CargoID c = 0; c < NUM_CARGO; c++) {
+		const GoodsEntry &ge = st->goods[c];
+		if (ge.status == 0 && ge.cargo.TotalCount() == 0) continue;
+		h.Add(((uint64)c << 56) | ((uint64)ge.status << 48) | ((uint64)ge.rating << 40) | ((uint64)ge.time_since_pickup << 32) | ge.cargo.TotalCount());
+	}
+	return h.state;
+}
+
+static uint64 HashCompany(const Company *c)
+{
+	StateHasher h;
+	h.Add(c->index);
+	h.Add((uint64)(int64)c->money);
+	h.Add((uint64)(int64)c->current_loan);
+	return h.state;
+}
+
+static uint64 HashTown(const Town *t)
+{
+	StateHasher h;
+	h.Add(t->index);
+	h.Add(((uint64)t->xy << 32) | t->cache.population);
+	h.Add(((uint64)t->grow_counter << 16) | t->growth_rate);
+	return h.state;
+}
+
+static uint64 HashIndustry(const Industry *ind)
+{
+	StateHasher h;
+	h.Add(ind->index);
+	h.Add(((uint64)ind->location.tile << 32) | ((uint64)ind->type << 16) | ind->owner);
+	for (uint i = 0; i < INDUSTRY_NUM_OUTPUTS; i++) {
+		h.Add(((uint64)ind->produced_cargo_waiting[i] << 32) | ((uint64)ind->production_rate[i] << 16) | ind->this_month_production[i]);
+	}
+	return h.state;
+}
+
+/**
+ * Compute the whole tree from the current game state.
+ * @param frame The current frame counter value, for reference.
+ */
+void StateHashTree::Compute(uint32 frame)
+{
+	this->frame = frame;
+	this->date = _date;
+	this->date_fract = _date_fract;
+	this->tick_skip_counter = _tick_skip_counter;
+
+	for (uint i = 0; i < SHS_END; i++) this->leaves[i].clear();
+
+	for (const Vehicle *v : Vehicle::Iterate()) {
+		this->leaves[SHS_VEHICLES].push_back({ v->index, HashVehicle(v) });
+	}
+	for (const Station *st : Station::Iterate()) {
+		this->leaves[SHS_STATIONS].push_back({ st->index, HashStation(st) });
+	}
+	{
+		std::vector<Leaf> &leaves = this->leaves[SHS_CARGO_PACKETS];
+		for (const CargoPacket *cp : CargoPacket::Iterate()) {
+			const uint32 id = cp->index / STATE_HASH_CARGO_PACKET_BLOCK;
+			if (leaves.empty() || leaves.back().id != id) leaves.push_back({ id, StateHasher().state });
+			StateHasher h;
+			h.state = leaves.back().hash;
+			h.Add(cp->index);
+			h.Add(((uint64)cp->SourceStationXY() << 32) | ((uint64)cp->SourceStation() << 16) | cp->Count());
+			h.Add(((uint64)cp->SourceSubsidyID() << 16) | ((uint64)cp->SourceSubsidyType() << 8) | cp->DaysInTransit());
+			h.Add((uint64)(int64)cp->FeederShare());
+			leaves.back().hash = h.state;
+		}
+	}
+	for (const Company *c : Company::Iterate()) {
+		this->leaves[SHS_COMPANIES].push_back({ c->index, HashCompany(c) });
+	}
+	for (const Town *t : Town::Iterate()) {
+		this->leaves[SHS_TOWNS].push_back({ t->index, HashTown(t) });
+	}
+	for (const Industry *ind : Industry::Iterate()) {
+		this->leaves[SHS_INDUSTRIES].push_back({ ind->index, HashIndustry(ind) });
+	}
+
+	const uint chunks_x = CeilDiv(MapSizeX(), STATE_HASH_TILE_CHUNK);
+	const uint chunks_y = CeilDiv(MapSizeY(), STATE_HASH_TILE_CHUNK);
+	for (uint cy = 0; cy < chunks_y; cy++) {
+		for (uint cx = 0; cx < chunks_x; cx++) {
+			StateHasher h;
+			const uint end_x = std::min((cx + 1) * STATE_HASH_TILE_CHUNK, MapSizeX());
+			const uint end_y = std::min((cy + 1) * STATE_HASH_TILE_CHUNK, MapSizeY());
+			for (uint y = cy * STATE_HASH_TILE_CHUNK; y < end_y; y++) {
+				for (uint x = cx * STATE_HASH_TILE_CHUNK; x < end_x; x++) {
+					const TileIndex t = TileXY(x, y);
+					const Tile &m = _m[t];
+					const TileExtended &me = _me[t];
+					h.Add(((uint64)m.type << 56) | ((uint64)m.height << 48) | ((uint64)m.m2 << 32) | ((uint64)m.m1 << 24) | ((uint64)m.m3 << 16) | ((uint64)m.m4 << 8) | m.m5);
+					h.Add(((uint64)me.m6 << 24) | ((uint64)me.m7 << 16) | me.m8);
+				}
+			}
+			this->leaves[SHS_TILES].push_back({ cy * chunks_x + cx, h.state });
+		}
+	}
+
+	this->UpdateInnerHashes();
+}
+
+/**
+ * Recompute the subsystem and root hashes from the leaves.
+ */
+void StateHashTree::UpdateInnerHashes()
+{
+	StateHasher root;
+	for (uint i = 0; i < SHS_END; i++) {
+		StateHasher h;
+		h.Add(i);
+		for (const Leaf &leaf : this->leaves[i]) {
+			h.Add(leaf.id);
+			h.Add(leaf.hash);
+		}
+		this->subsystems[i] = h.state;
+		root.Add(h.state);
+	}
+	this->root = root.state;
+}
+
+/**
+ * Get the hash of a block of leaves.
+ * @param subsystem The subsystem.
+ * @param block The block number, leaves with IDs from block * STATE_HASH_BLOCK_SIZE are included.
+ * @return The block hash.
+ */
+uint64 StateHashTree::GetBlockHash(StateHashSubsystem subsystem, uint32 block) const
+{
+	const std::vector<Leaf> &leaves = this->leaves[subsystem];
+	auto it = std::lower_bound(leaves.begin(), leaves.end(), block * STATE_HASH_BLOCK_SIZE, [](const Leaf &leaf, uint32 id) {
+		return leaf.id < id;
+	});
+	StateHasher h;
+	h.Add(block);
+	for (; it != leaves.end() && it->id / STATE_HASH_BLOCK_SIZE == block; ++it) {
+		h.Add(it->id);
+		h.Add(it->hash);
+	}
+	return h.state;
+}
+
+/**
+ * Output the tree.
+ * @param print Function to output each line with.
+ * @param with_blocks Whether to also output the hash of each non-empty block.
+ */
+void StateHashTree::Dump(std::function<void(const char *)> print, bool with_blocks) const
+{
+	char buffer[256];
+	YearMonthDay ymd;
+	ConvertDateToYMD(this->date, &ymd);
+	seprintf(buffer, lastof(buffer), "Root: " OTTD_PRINTFHEX64PAD ", frame: %u, date: %i-%02i-%02i (%i, %i)",
+			this->root, this->frame, ymd.year, ymd.month + 1, ymd.day, this->date_fract, this->tick_skip_counter);
+	print(buffer);
+	for (uint i = 0; i < SHS_END; i++) {
+		seprintf(buffer, lastof(buffer), "  %s: " OTTD_PRINTFHEX64PAD ", %u leaves", GetStateHashSubsystemName((StateHashSubsystem)i), this->subsystems[i], (uint)this->leaves[i].size());
+		print(buffer);
+		if (!with_blocks) continue;
+		uint32 last_block = UINT32_MAX;
+		for (const Leaf &leaf : this->leaves[i]) {
+			const uint32 block = leaf.id / STATE_HASH_BLOCK_SIZE;
+			if (block == last_block) continue;
+			last_block = block;
+			seprintf(buffer, lastof(buffer), "    block %u: " OTTD_PRINTFHEX64PAD, block, this->GetBlockHash((StateHashSubsystem)i, block));
+			print(buffer);
+		}
+	}
+}
+
+/**
+ * Describe a leaf, using the local game state where available.
+ * @param b Buffer to write to.
+ * @param last Last valid byte of the buffer.
+ * @param subsystem The subsystem of the leaf.
+ * @param id The leaf ID.
+ * @return The new end of the written string.
+ */
+static char *DescribeStateHashLeaf(char *b, const char *last, StateHashSubsystem subsystem, uint32 id)
+{
+	switch (subsystem) {
+		case SHS_VEHICLES: {
+			b += seprintf(b, last, "vehicle %u", id);
+			const Vehicle *v = Vehicle::GetIfValid(id);
+			if (v != nullptr) {
+				b += seprintf(b, last, " (type: %u, unit: %u, owner: %u, tile: %u x %u)", v->type, v->First()->unitnumber, v->owner, TileX(v->tile), TileY(v->tile));
+			}
+			break;
+		}
+
+		case SHS_STATIONS: {
+			b += seprintf(b, last, "station %u", id);
+			const Station *st = Station::GetIfValid(id);
+			if (st != nullptr) b += seprintf(b, last, " (tile: %u x %u)", TileX(st->xy), TileY(st->xy));
+			break;
+		}
+
+		case SHS_CARGO_PACKETS:
+			b += seprintf(b, last, "cargo packets %u - %u", id * STATE_HASH_CARGO_PACKET_BLOCK, (id + 1) * STATE_HASH_CARGO_PACKET_BLOCK - 1);
+			break;
+
+		case SHS_COMPANIES:
+			b += seprintf(b, last, "company %u", id + 1);
+			break;
+
+		case SHS_TOWNS: {
+			b += seprintf(b, last, "town %u", id);
+			const Town *t = Town::GetIfValid(id);
+			if (t != nullptr) b += seprintf(b, last, " (tile: %u x %u)", TileX(t->xy), TileY(t->xy));
+			break;
+		}
+
+		case SHS_INDUSTRIES: {
+			b += seprintf(b, last, "industry %u", id);
+			const Industry *ind = Industry::GetIfValid(id);
+			if (ind != nullptr) b += seprintf(b, last, " (type: %u, tile: %u x %u)", ind->type, TileX(ind->location.tile), TileY(ind->location.tile));
+			break;
+		}
+
+		case SHS_TILES: {
+			const uint chunks_x = CeilDiv(MapSizeX(), STATE_HASH_TILE_CHUNK);
+			const uint x = (id % chunks_x) * STATE_HASH_TILE_CHUNK;
+			const uint y = (id / chunks_x) * STATE_HASH_TILE_CHUNK;
+			b += seprintf(b, last, "tiles %u - %u x %u - %u", x, x + STATE_HASH_TILE_CHUNK - 1, y, y + STATE_HASH_TILE_CHUNK - 1);
+			break;
+		}
+
+		default:
+			b += seprintf(b, last, "leaf %u", id);
+			break;
+	}
+	return b;
+}
+
+/**
+ * Compare two state hash trees of the same frame, and describe where they differ.
+ * The comparison descends the tree, so only leaves of differing subsystems are examined.
+ * @param ours The locally computed tree.
+ * @param theirs The tree received from the other party.
+ * @param max_reported Maximum number of differing leaves to report per subsystem.
+ * @return A multi-line description of the differences.
+ */
+std::string CompareStateHashTrees(const StateHashTree &ours, const StateHashTree &theirs, uint max_reported)
+{
+	std::string result;
+	char buffer[512];
+
+	if (ours.frame != theirs.frame) {
+		seprintf(buffer, lastof(buffer), "Frame mismatch: %u != %u, trees are not comparable\n", ours.frame, theirs.frame);
+		result += buffer;
+		return result;
+	}
+
+	if (ours.root == theirs.root) {
+		seprintf(buffer, lastof(buffer), "Root hashes match (" OTTD_PRINTFHEX64PAD "), the difference is not in the hashed state\n", ours.root);
+		result += buffer;
+		return result;
+	}
+
+	for (uint i = 0; i < SHS_END; i++) {
+		const StateHashSubsystem subsystem = (StateHashSubsystem)i;
+		if (ours.subsystems[i] == theirs.subsystems[i]) continue;
+
+		seprintf(buffer, lastof(buffer), "Subsystem %s differs: " OTTD_PRINTFHEX64PAD " != " OTTD_PRINTFHEX64PAD "\n", GetStateHashSubsystemName(subsystem), ours.subsystems[i], theirs.subsystems[i]);
+		result += buffer;
+
+		const std::vector<StateHashTree::Leaf> &a = ours.leaves[i];
+		const std::vector<StateHashTree::Leaf> &b = theirs.leaves[i];
+		auto ia = a.begin();
+		auto ib = b.begin();
+		uint reported = 0;
+		uint total = 0;
+		while (ia != a.end() || ib != b.end()) {
+			const char *state;
+			uint32 id;
+			if (ib == b.end() || (ia != a.end() && ia->id < ib->id)) {
+				id = ia->id;
+				state = "only here";
+				++ia;
+			} else if (ia == a.end() || ib->id < ia->id) {
+				id = ib->id;
+				state = "only there";
+				++ib;
+			} else {
+				id = ia->id;
+				const bool same = (ia->hash == ib->hash);
+				++ia;
+				++ib;
+				if (same) continue;
+				state = "differs";
+			}
+			total++;
+			if (reported < max_reported) {
+				char *p = buffer + seprintf(buffer, lastof(buffer), "  block %u: ", id / STATE_HASH_BLOCK_SIZE);
+				p = DescribeStateHashLeaf(p, lastof(buffer), subsystem, id);
+				seprintf(p, lastof(buffer), ": %s\n", state);
+				result += buffer;
+				reported++;
+			}
+		}
+		if (total > reported) {
+			seprintf(buffer, lastof(buffer), "  ... and %u more\n", total - reported);
+			result += buffer;
+		}
+	}
+
+	return result;
+}
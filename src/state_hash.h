@@ -0,0 +1,64 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file state_hash.h Hierarchical hashes of the game state, for locating the source of desyncs. */
+
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include "date_type.h"
+#include <vector>
+#include <string>
+#include <functional>
+
+/** Subsystems covered by the hierarchical state hash. */
+enum StateHashSubsystem : uint8 {
+	SHS_VEHICLES,          ///< Vehicles, one leaf per vehicle
+	SHS_STATIONS,          ///< Stations, one leaf per station
+	SHS_CARGO_PACKETS,     ///< Cargo packets, one leaf per block of STATE_HASH_CARGO_PACKET_BLOCK packets
+	SHS_COMPANIES,         ///< Companies, one leaf per company
+	SHS_TOWNS,             ///< Towns, one leaf per town
+	SHS_INDUSTRIES,        ///< Industries, one leaf per industry
+	SHS_TILES,             ///< Map tiles, one leaf per STATE_HASH_TILE_CHUNK x STATE_HASH_TILE_CHUNK chunk
+	SHS_END,
+};
+
+static const uint STATE_HASH_BLOCK_SIZE = 64;             ///< Number of leaves combined into one block hash
+static const uint STATE_HASH_CARGO_PACKET_BLOCK = 256;    ///< Number of cargo packets (by pool index) per leaf
+static const uint STATE_HASH_TILE_CHUNK = 64;             ///< Width and height of the tile chunk of one leaf
+
+/**
+ * Hash tree of the game state at one frame.
+ * The levels are: root, subsystem, block of STATE_HASH_BLOCK_SIZE leaves, leaf.
+ * Leaves are keyed by an ID, which is the pool index for pool items, the pool index divided by
+ * STATE_HASH_CARGO_PACKET_BLOCK for cargo packets, and the chunk index (chunk_y * chunks_per_row + chunk_x) for tiles.
+ */
+struct StateHashTree {
+	/** Hash of a single leaf. */
+	struct Leaf {
+		uint32 id;    ///< ID of the leaf
+		uint64 hash;  ///< Hash of the leaf
+	};
+
+	uint32 frame = 0;                   ///< Frame counter value the tree was computed at
+	Date date = 0;                      ///< Date the tree was computed at
+	DateFract date_fract = 0;           ///< Date fraction the tree was computed at
+	uint8 tick_skip_counter = 0;        ///< Tick skip counter value the tree was computed at
+	uint64 root = 0;                    ///< Root hash
+	uint64 subsystems[SHS_END] = {};    ///< Hash per subsystem
+	std::vector<Leaf> leaves[SHS_END];  ///< Leaves per subsystem, sorted by ID
+
+	void Compute(uint32 frame);
+	void UpdateInnerHashes();
+	uint64 GetBlockHash(StateHashSubsystem subsystem, uint32 block) const;
+	void Dump(std::function<void(const char *)> print, bool with_blocks) const;
+};
+
+const char *GetStateHashSubsystemName(StateHashSubsystem subsystem);
+std::string CompareStateHashTrees(const StateHashTree &ours, const StateHashTree &theirs, uint max_reported = 32);
+
+#endif /* STATE_HASH_H */
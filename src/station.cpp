@@ -43,14 +43,18 @@ uint _extra_station_names_used;
 
 
 StationKdtree _station_kdtree(Kdtree_StationXYFunc);
+AirportKdtree _airport_kdtree(Kdtree_AirportXYFunc);
 
 void RebuildStationKdtree()
 {
 	std::vector<StationID> stids;
+	std::vector<StationID> airport_stids;
 	for (const Station *st : Station::Iterate()) {
 		stids.push_back(st->index);
+		if ((st->facilities & FACIL_AIRPORT) && st->airport.type != AT_OILRIG) airport_stids.push_back(st->index);
 	}
 	_station_kdtree.Build(stids.begin(), stids.end());
+	_airport_kdtree.Build(airport_stids.begin(), airport_stids.end());
 }
 
 
@@ -405,8 +409,10 @@ void Station::AddIndustryToDeliver(Industry *ind)
  */
 void Station::RemoveFromAllNearbyLists()
 {
-	for (Town *t : Town::Iterate()) { t->stations_near.erase(this); }
-	for (Industry *i : Industry::Iterate()) { i->stations_near.erase(this); }
+	for (Town *t : this->towns_catchment) { t->stations_near.erase(this); }
+	for (Industry *i : this->industries_catchment) { i->stations_near.erase(this); }
+	this->towns_catchment.clear();
+	this->industries_catchment.clear();
 }
 
 /**
@@ -450,9 +456,11 @@ void Station::RecomputeCatchment(bool no_clear_nearby_lists)
 		/* The industry's stations_near may have been computed before its neutral station was built so clear and re-add here. */
 		for (Station *st : this->industry->stations_near) {
 			st->industries_near.erase(this->industry);
+			st->industries_catchment.erase(this->industry);
 		}
 		this->industry->stations_near.clear();
 		this->industry->stations_near.insert(this);
+		this->industries_catchment.insert(this->industry);
 		this->industries_near.insert(this->industry);
 
 		/* Loop finding all station tiles */
@@ -489,6 +497,7 @@ void Station::RecomputeCatchment(bool no_clear_nearby_lists)
 		if (IsTileType(tile, MP_HOUSE)) {
 			Town *t = Town::GetByTile(tile);
 			t->stations_near.insert(this);
+			this->towns_catchment.insert(t);
 		}
 		if (IsTileType(tile, MP_INDUSTRY)) {
 			Industry *i = Industry::GetByTile(tile);
@@ -497,6 +506,7 @@ void Station::RecomputeCatchment(bool no_clear_nearby_lists)
 			if (!_settings_game.station.serve_neutral_industries && i->neutral_station != nullptr) continue;
 
 			i->stations_near.insert(this);
+			this->industries_catchment.insert(i);
 
 			/* Add if we can deliver to this industry as well */
 			this->AddIndustryToDeliver(i);
@@ -512,6 +522,10 @@ void Station::RecomputeCatchment(bool no_clear_nearby_lists)
 {
 	for (Town *t : Town::Iterate()) { t->stations_near.clear(); }
 	for (Industry *i : Industry::Iterate()) { i->stations_near.clear(); }
+	for (Station *st : Station::Iterate()) {
+		st->towns_catchment.clear();
+		st->industries_catchment.clear();
+	}
 	for (Station *st : Station::Iterate()) { st->RecomputeCatchment(true); }
 }
 
@@ -793,6 +793,12 @@ struct IndustryCompare {
 
 typedef btree::btree_set<Industry *, IndustryCompare> IndustryList;
 
+struct TownCompare {
+	bool operator() (const Town *lhs, const Town *rhs) const;
+};
+
+typedef btree::btree_set<Town *, TownCompare> NearbyTownList;
+
 /** Station data structure */
 struct Station FINAL : SpecializedStation<Station, false> {
 public:
@@ -829,6 +835,8 @@ public:
 	CargoTypes always_accepted;       ///< Bitmask of always accepted cargo types (by houses, HQs, industry tiles when industry doesn't accept cargo)
 
 	IndustryList industries_near; ///< Cached list of industries near the station that can accept cargo, @see DeliverGoodsToIndustry()
+	NearbyTownList towns_catchment;    ///< NOSAVE: Towns which have this station in their Town::stations_near
+	IndustryList industries_catchment; ///< NOSAVE: Industries which have this station in their Industry::stations_near
 	Industry *industry;           ///< NOSAVE: Associated industry for neutral stations. (Rebuilt on load from Industry->st)
 
 	CargoTypes station_cargo_history_cargoes;                                              ///< Bitmask of cargoes in station_cargo_history
@@ -2633,6 +2633,7 @@ CommandCost CmdBuildAirport(TileIndex tile, DoCommandFlag flags, uint32 p1, uint
 				DeleteNewGRFInspectWindow(GSF_AIRPORTTILES, tile_cur);
 			}
 
+			_airport_kdtree.Remove(st->index);
 			st->rect.AfterRemoveRect(st, st->airport);
 			st->airport.Clear();
 		}
@@ -2656,6 +2657,8 @@ CommandCost CmdBuildAirport(TileIndex tile, DoCommandFlag flags, uint32 p1, uint
 			if (AirportTileSpec::Get(GetTranslatedAirportTileID(iter.GetStationGfx()))->animation.status != ANIM_STATUS_NO_ANIMATION) AddAnimatedTile(iter);
 		}
 
+		_airport_kdtree.Insert(st->index);
+
 		/* Only call the animation trigger after all tiles have been built */
 		for (AirportTileTableIterator iter(as->table[layout], tile); iter != INVALID_TILE; ++iter) {
 			AirportTileAnimationTrigger(st, iter, AAT_BUILT);
@@ -2725,6 +2728,7 @@ static CommandCost RemoveAirport(TileIndex tile, DoCommandFlag flags)
 		/* Clear the persistent storage. */
 		delete st->airport.psa;
 
+		_airport_kdtree.Remove(st->index);
 		st->rect.AfterRemoveRect(st, st->airport);
 
 		st->airport.Clear();
@@ -19,6 +19,11 @@ inline uint32 Kdtree_StationXYFunc(StationID stid, int dim) { return (dim == 0)
 typedef Kdtree<StationID, decltype(&Kdtree_StationXYFunc), uint32, int> StationKdtree;
 extern StationKdtree _station_kdtree;
 
+inline uint32 Kdtree_AirportXYFunc(StationID stid, int dim) { return (dim == 0) ? TileX(Station::Get(stid)->airport.tile) : TileY(Station::Get(stid)->airport.tile); }
+typedef Kdtree<StationID, decltype(&Kdtree_AirportXYFunc), uint32, int> AirportKdtree;
+/** Stations with an airport, other than oil rigs, by the north tile of the airport. Used to look for hangars. */
+extern AirportKdtree _airport_kdtree;
+
 /**
  * Call a function on all stations whose sign is within a radius of a center tile.
  * @param center  Central tile to search around.
@@ -145,6 +145,10 @@ Town::~Town()
 	/* Clear the persistent storage list. */
 	this->psa_list.clear();
 
+	for (Station *st : this->stations_near) {
+		st->towns_catchment.erase(this);
+	}
+
 	DeleteSubsidyWith(ST_TOWN, this->index);
 	DeleteNewGRFInspectWindow(GSF_FAKE_TOWNS, this->index);
 	CargoPacket::InvalidateAllFrom(ST_TOWN, this->index);
@@ -579,7 +583,7 @@ uint32 GetWorldPopulation()
 static void RemoveNearbyStations(Town *t, TileIndex tile, BuildingFlags flags)
 {
 	for (StationList::iterator it = t->stations_near.begin(); it != t->stations_near.end(); /* incremented inside loop */) {
-		const Station *st = *it;
+		Station *st = *it;
 
 		bool covers_area = st->TileIsInCatchment(tile);
 		if (flags & BUILDING_2_TILES_Y)   covers_area |= st->TileIsInCatchment(tile + TileDiffXY(0, 1));
@@ -587,6 +591,7 @@ static void RemoveNearbyStations(Town *t, TileIndex tile, BuildingFlags flags)
 		if (flags & BUILDING_HAS_4_TILES) covers_area |= st->TileIsInCatchment(tile + TileDiffXY(1, 1));
 
 		if (covers_area && !st->CatchmentCoversTown(t->index)) {
+			st->towns_catchment.erase(t);
 			it = t->stations_near.erase(it);
 		} else {
 			++it;
@@ -2576,6 +2581,7 @@ static void MakeTownHouse(TileIndex t, Town *town, byte counter, byte stage, Hou
 	if (!_generating_world) {
 		ForAllStationsAroundTiles(TileArea(t, (size & BUILDING_2_TILES_X) ? 2 : 1, (size & BUILDING_2_TILES_Y) ? 2 : 1), [town](Station *st, TileIndex tile) {
 			town->stations_near.insert(st);
+			st->towns_catchment.insert(town);
 			return true;
 		});
 	}
@@ -4229,6 +4235,11 @@ extern const TileTypeProcs _tile_type_town_procs = {
 	TerraformTile_Town,      // terraform_tile_proc
 };
 
+bool TownCompare::operator() (const Town *lhs, const Town *rhs) const
+{
+	return lhs->index < rhs->index;
+}
+
 
 HouseSpec _house_specs[NUM_HOUSES];
 
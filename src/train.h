@@ -477,6 +477,12 @@ struct TrainDecelerationStats {
 	int deceleration_x2;
 	int uncapped_deceleration_x2;
 	int z_pos;
+	bool slope_braking;                ///< Whether descending slopes lengthen the braking distance
+	bool speed_dependent_braking;      ///< Whether the braking force when descending depends on the speed
+	int slope_ke_factor;               ///< Kinetic energy gained per unit of height descended, when #slope_braking
+	uint braking_weight;               ///< Weight of the train, when #speed_dependent_braking
+	int64 braking_power_w;             ///< Braking power of the train, when #speed_dependent_braking
+	int64 min_braking_force;           ///< Minimum braking force of the train, when #speed_dependent_braking
 	const Train *t;
 
 	TrainDecelerationStats(const Train *t);
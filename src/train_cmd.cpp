@@ -77,7 +77,7 @@ enum ChooseTrainTrackFlags {
 };
 DECLARE_ENUM_AS_BIT_SET(ChooseTrainTrackFlags)
 
-std::unordered_map<SignalSpeedKey, SignalSpeedValue, SignalSpeedKeyHashFunc> _signal_speeds(1 << 16);
+SignalSpeedStore _signal_speeds;
 
 static void TryLongReserveChooseTrainTrackFromReservationEnd(Train *v, bool no_reserve_vehicle_tile = false);
 static Track ChooseTrainTrack(Train *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, ChooseTrainTrackFlags flags, bool *p_got_reservation, ChooseTrainTrackLookAheadState lookahead_state = {});
@@ -119,26 +119,18 @@ static bool IsOutOfDate(const SignalSpeedValue& value)
 /** Removes all speed restrictions from all signals */
 void ClearAllSignalSpeedRestrictions()
 {
-	_signal_speeds.clear();
+	_signal_speeds.Clear();
 }
 
 void AdjustAllSignalSpeedRestrictionTickValues(DateTicksScaled delta)
 {
-	for (auto &it : _signal_speeds) {
-		it.second.time_stamp += delta;
-	}
+	_signal_speeds.AdjustTimeStamps(delta);
 }
 
 /** Removes all speed restrictions which have passed their timeout from all signals */
 void ClearOutOfDateSignalSpeedRestrictions()
 {
-	for(auto key_value_pair = _signal_speeds.begin(); key_value_pair != _signal_speeds.end(); ) {
-		if (IsOutOfDate(key_value_pair->second)) {
-			key_value_pair = _signal_speeds.erase(key_value_pair);
-		} else {
-			++key_value_pair;
-		}
-	}
+	_signal_speeds.ClearOutOfDate(_scaled_date_ticks);
 }
 
 inline void ClearLookAheadIfInvalid(Train *v)
@@ -796,6 +788,16 @@ TrainDecelerationStats::TrainDecelerationStats(const Train *t)
 		}
 		this->z_pos = sum / t->gcache.cached_weight;
 	}
+
+	/* Everything the braking curves need which does not depend on the lookahead item, so it is not recomputed per item. */
+	this->slope_braking = _settings_game.vehicle.train_acceleration_model != AM_ORIGINAL;
+	this->slope_ke_factor = 400 * _settings_game.vehicle.train_slope_steepness;
+	this->speed_dependent_braking = _settings_game.vehicle.train_acceleration_model == AM_REALISTIC && GetRailTypeInfo(t->railtype)->acceleration_type != 2;
+	if (this->speed_dependent_braking) {
+		this->braking_weight = t->gcache.cached_weight;
+		this->braking_power_w = (t->gcache.cached_power * 746ll) + (t->gcache.cached_total_length * (int64)RBC_BRAKE_POWER_PER_LENGTH);
+		this->min_braking_force = (t->gcache.cached_total_length * (int64)RBC_BRAKE_FORCE_PER_LENGTH) + t->gcache.cached_axle_resistance + (this->braking_weight * 16);
+	}
 	this->t = t;
 }
 
@@ -809,9 +811,9 @@ static int64 GetRealisticBrakingDistanceForSpeed(const TrainDecelerationStats &s
 
 	int64 dist = ke_delta / stats.deceleration_x2;
 
-	if (z_delta < 0 && _settings_game.vehicle.train_acceleration_model != AM_ORIGINAL) {
+	if (z_delta < 0 && stats.slope_braking) {
 		/* descending */
-		int64 slope_dist = (ke_delta - (z_delta * 400 * _settings_game.vehicle.train_slope_steepness)) / stats.uncapped_deceleration_x2;
+		int64 slope_dist = (ke_delta - (z_delta * stats.slope_ke_factor)) / stats.uncapped_deceleration_x2;
 		dist = std::max<int64>(dist, slope_dist);
 	}
 	return dist;
@@ -828,17 +830,16 @@ static int GetRealisticBrakingSpeedForDistance(const TrainDecelerationStats &sta
 
 	if (speed_sqr <= REALISTIC_BRAKING_MIN_SPEED * REALISTIC_BRAKING_MIN_SPEED) return REALISTIC_BRAKING_MIN_SPEED;
 
-	if (z_delta < 0 && _settings_game.vehicle.train_acceleration_model != AM_ORIGINAL) {
+	if (z_delta < 0 && stats.slope_braking) {
 		/* descending */
-		int64 sloped_ke = target_ke + (z_delta * 400 * _settings_game.vehicle.train_slope_steepness);
+		int64 sloped_ke = target_ke + (z_delta * stats.slope_ke_factor);
 		int64 slope_speed_sqr = sloped_ke + ((int64)stats.uncapped_deceleration_x2 * (int64)distance);
-		if (slope_speed_sqr < speed_sqr &&
-				_settings_game.vehicle.train_acceleration_model == AM_REALISTIC && GetRailTypeInfo(stats.t->railtype)->acceleration_type != 2) {
+		if (slope_speed_sqr < speed_sqr && stats.speed_dependent_braking) {
 			/* calculate speed at which braking would be sufficient */
 
-			uint weight = stats.t->gcache.cached_weight;
-			int64 power_w = (stats.t->gcache.cached_power * 746ll) + (stats.t->gcache.cached_total_length * (int64)RBC_BRAKE_POWER_PER_LENGTH);
-			int64 min_braking_force = (stats.t->gcache.cached_total_length * (int64)RBC_BRAKE_FORCE_PER_LENGTH) + stats.t->gcache.cached_axle_resistance + (weight * 16);
+			const uint weight = stats.braking_weight;
+			const int64 power_w = stats.braking_power_w;
+			const int64 min_braking_force = stats.min_braking_force;
 
 			/* F = (7/8) * (F_min + ((power_w * 18) / (5 * v)))
 			 * v^2 = sloped_ke + F * s / (4 * m)
@@ -899,6 +900,20 @@ void LimitSpeedFromLookAhead(int &max_speed, const TrainDecelerationStats &stats
 	}
 }
 
+/**
+ * Check whether stopping at or beyond a lookahead position can not limit the speed.
+ * @param max_speed The speed limit so far.
+ * @param stats The deceleration stats of the train.
+ * @param current_position The current position of the train.
+ * @param position The nearest position at which the train may have to stop.
+ * @param z_delta The height difference between the train and the position.
+ * @return true if the train can stop there from \a max_speed, however far beyond the position it has to stop.
+ */
+static bool IsStopBeyondBrakingDistance(int max_speed, const TrainDecelerationStats &stats, int current_position, int position, int z_delta)
+{
+	return position > current_position && (max_speed <= 0 || GetRealisticBrakingDistanceForSpeed(stats, max_speed, 0, z_delta) + current_position <= position);
+}
+
 static void ApplyLookAheadItem(const Train *v, const TrainReservationLookAheadItem &item, int &max_speed, int &advisory_max_speed,
 		VehicleOrderID &current_order_index, const Order *&order, StationID &last_station_visited, const TrainDecelerationStats &stats, int current_position)
 {
@@ -913,7 +928,10 @@ static void ApplyLookAheadItem(const Train *v, const TrainReservationLookAheadIt
 	switch (item.type) {
 		case TRLIT_STATION: {
 			if (order->ShouldStopAtStation(last_station_visited, item.data_id, Waypoint::GetIfValid(item.data_id) != nullptr)) {
-				limit_advisory_speed(item.start + PredictStationStoppingLocation(v, order, item.end - item.start, item.data_id), 0, item.z_pos);
+				/* The stopping location is not before the start of the platform, so do not predict it when stopping there is no constraint yet. */
+				if (!IsStopBeyondBrakingDistance(advisory_max_speed, stats, current_position, item.start, item.z_pos - stats.z_pos)) {
+					limit_advisory_speed(item.start + PredictStationStoppingLocation(v, order, item.end - item.start, item.data_id), 0, item.z_pos);
+				}
 				last_station_visited = item.data_id;
 			} else if (order->IsType(OT_GOTO_WAYPOINT) && order->GetDestination() == item.data_id && (order->GetWaypointFlags() & OWF_REVERSE)) {
 				limit_advisory_speed(item.start + v->gcache.cached_total_length, 0, item.z_pos);
@@ -5658,14 +5676,14 @@ bool TrainController(Train *v, Vehicle *nomove, bool reverse)
 							speed_key.signal_track = track,
 							speed_key.last_passing_train_dir = v->GetVehicleTrackdir()
 						};
-						const auto found_speed_restriction = _signal_speeds.find(speed_key);
+						const SignalSpeedValue *found_speed_restriction = _signal_speeds.Find(speed_key);
 
-						if (found_speed_restriction != _signal_speeds.end()) {
-							if (IsOutOfDate(found_speed_restriction->second)) {
-								_signal_speeds.erase(found_speed_restriction);
+						if (found_speed_restriction != nullptr) {
+							if (IsOutOfDate(*found_speed_restriction)) {
+								_signal_speeds.Erase(speed_key);
 								v->signal_speed_restriction = 0;
 							} else {
-								v->signal_speed_restriction = std::max<uint16>(25, found_speed_restriction->second.train_speed);
+								v->signal_speed_restriction = std::max<uint16>(25, found_speed_restriction->train_speed);
 							}
 						} else {
 							v->signal_speed_restriction = 0;
@@ -5725,7 +5743,7 @@ bool TrainController(Train *v, Vehicle *nomove, bool reverse)
 							speed_value.train_speed = v->First()->cur_speed,
 							speed_value.time_stamp = GetSpeedRestrictionTimeout(v->First())
 						};
-						_signal_speeds[speed_key] = speed_value;
+						_signal_speeds.Set(speed_key, speed_value);
 					}
 
 					if (HasSignalOnTrack(gp.old_tile, track)) {
@@ -0,0 +1,270 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file train_speed_adaptation.cpp Train speed adaptation data structures. */
+
+#include "stdafx.h"
+#include "train_speed_adaptation.h"
+#include "string_func.h"
+
+#include <algorithm>
+
+#include "safeguards.h"
+
+/**
+ * Get the index of the slot at which the search for a key starts.
+ * @param key The key.
+ * @return The home slot index.
+ */
+size_t SignalSpeedStore::GetHomeIndex(const SignalSpeedKey &key) const
+{
+	const uint64 hash = (((uint64)key.signal_tile << 8) | ((uint64)key.signal_track << 4) | (uint64)key.last_passing_train_dir) * 0x9E3779B97F4A7C15ULL;
+	return (size_t)(hash >> (64 - this->table_bits));
+}
+
+/**
+ * Find the slot of a key.
+ * @param key The key.
+ * @return The slot index, or SIZE_MAX if the key is not in the table.
+ */
+size_t SignalSpeedStore::FindIndex(const SignalSpeedKey &key) const
+{
+	const size_t mask = this->table.size() - 1;
+	for (size_t index = this->GetHomeIndex(key);; index = (index + 1) & mask) {
+		const Entry &entry = this->table[index];
+		if (!entry.used) return SIZE_MAX;
+		if (entry.key == key) return index;
+	}
+}
+
+/**
+ * Erase the entry in a slot, and move the following entries of the probe sequence back so no tombstone is required.
+ * @param index The slot index.
+ */
+void SignalSpeedStore::EraseIndex(size_t index)
+{
+	const size_t mask = this->table.size() - 1;
+	size_t hole = index;
+	for (size_t next = (hole + 1) & mask; this->table[next].used; next = (next + 1) & mask) {
+		/* The entry may only be moved into the hole when the hole is not before its home slot. */
+		const size_t home = this->GetHomeIndex(this->table[next].key);
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			this->table[hole] = this->table[next];
+			hole = next;
+		}
+	}
+	this->table[hole].used = false;
+	this->count--;
+}
+
+/**
+ * Rehash the table into a table of a new size.
+ * @param bits Number of bits of the new table size.
+ */
+void SignalSpeedStore::Resize(uint bits)
+{
+	std::vector<Entry> old_table;
+	old_table.swap(this->table);
+	this->table_bits = bits;
+	this->table.assign((size_t)1 << bits, Entry{});
+
+	const size_t mask = this->table.size() - 1;
+	for (const Entry &entry : old_table) {
+		if (!entry.used) continue;
+		size_t index = this->GetHomeIndex(entry.key);
+		while (this->table[index].used) index = (index + 1) & mask;
+		this->table[index] = entry;
+	}
+}
+
+/**
+ * Register the expiry of an entry in the timing wheel.
+ * @param key The key of the entry.
+ * @param time_stamp The time stamp of the entry.
+ */
+void SignalSpeedStore::AddExpiry(const SignalSpeedKey &key, DateTicksScaled time_stamp)
+{
+	/* Time stamps before the last removal are visited by the next one, which starts at the slot of expired_until. */
+	const DateTicksScaled slot_time = std::max(time_stamp, this->expired_until) >> WHEEL_SLOT_BITS;
+	this->wheel[slot_time & (WHEEL_SLOTS - 1)].push_back({ key, time_stamp });
+}
+
+/**
+ * Register the expiries of all entries in the timing wheel from scratch.
+ */
+void SignalSpeedStore::RebuildWheel()
+{
+	for (std::vector<Expiry> &expiries : this->wheel) expiries.clear();
+	for (const Entry &entry : this->table) {
+		if (entry.used) this->AddExpiry(entry.key, entry.value.time_stamp);
+	}
+}
+
+/**
+ * Find the value of a key.
+ * @param key The key.
+ * @return The value, or nullptr if the key is not in the table.
+ */
+const SignalSpeedValue *SignalSpeedStore::Find(const SignalSpeedKey &key) const
+{
+	const size_t index = this->FindIndex(key);
+	return index != SIZE_MAX ? &this->table[index].value : nullptr;
+}
+
+/**
+ * Set the value of a key, inserting it if it is not in the table.
+ * @param key The key.
+ * @param value The value.
+ */
+void SignalSpeedStore::Set(const SignalSpeedKey &key, const SignalSpeedValue &value)
+{
+	size_t index = this->FindIndex(key);
+	if (index == SIZE_MAX) {
+		/* Keep the load factor at most one half, so that probe sequences stay short. */
+		if ((this->count + 1) * 2 > this->table.size()) this->Resize(this->table_bits + 1);
+
+		const size_t mask = this->table.size() - 1;
+		index = this->GetHomeIndex(key);
+		while (this->table[index].used) index = (index + 1) & mask;
+
+		Entry &entry = this->table[index];
+		entry.key = key;
+		entry.used = true;
+		this->count++;
+	} else if (this->table[index].value.time_stamp == value.time_stamp) {
+		/* The expiry in the wheel is still valid. */
+		this->table[index].value = value;
+		return;
+	}
+	this->table[index].value = value;
+	this->AddExpiry(key, value.time_stamp);
+}
+
+/**
+ * Erase a key, if it is in the table.
+ * Its expiry in the wheel becomes outdated, and is dropped when its slot is visited.
+ * @param key The key.
+ */
+void SignalSpeedStore::Erase(const SignalSpeedKey &key)
+{
+	const size_t index = this->FindIndex(key);
+	if (index != SIZE_MAX) this->EraseIndex(index);
+}
+
+/**
+ * Erase all entries.
+ */
+void SignalSpeedStore::Clear()
+{
+	this->table.clear();
+	this->count = 0;
+	this->Resize(MIN_TABLE_BITS);
+	for (std::vector<Expiry> &expiries : this->wheel) expiries.clear();
+	this->expired_until = 0;
+}
+
+/**
+ * Erase all entries with a time stamp before a given time.
+ * Only the wheel slots between the previous call and the given time are visited.
+ * @param now The time.
+ */
+void SignalSpeedStore::ClearOutOfDate(DateTicksScaled now)
+{
+	if (now <= this->expired_until) return;
+
+	/* Visit every wheel slot at most once, even when more than a whole turn of the wheel has passed. */
+	const DateTicksScaled first_slot_time = this->expired_until >> WHEEL_SLOT_BITS;
+	const DateTicksScaled last_slot_time = std::min<DateTicksScaled>((now - 1) >> WHEEL_SLOT_BITS, first_slot_time + WHEEL_SLOTS - 1);
+	for (DateTicksScaled slot_time = first_slot_time; slot_time <= last_slot_time; slot_time++) {
+		std::vector<Expiry> &expiries = this->wheel[slot_time & (WHEEL_SLOTS - 1)];
+		for (size_t i = 0; i < expiries.size();) {
+			const Expiry &expiry = expiries[i];
+			bool keep = false;
+			const size_t index = this->FindIndex(expiry.key);
+			if (index != SIZE_MAX && this->table[index].value.time_stamp == expiry.time_stamp) {
+				if (expiry.time_stamp < now) {
+					this->EraseIndex(index);
+				} else {
+					/* Expires in a later turn of the wheel. */
+					keep = true;
+				}
+			}
+			if (keep) {
+				i++;
+			} else {
+				expiries[i] = expiries.back();
+				expiries.pop_back();
+			}
+		}
+	}
+	this->expired_until = now;
+}
+
+/**
+ * Shift the time stamps of all entries, when the scaled date ticks are rebased.
+ * @param delta The change of the time stamps.
+ */
+void SignalSpeedStore::AdjustTimeStamps(DateTicksScaled delta)
+{
+	for (Entry &entry : this->table) {
+		if (entry.used) entry.value.time_stamp += delta;
+	}
+	this->expired_until += delta;
+	this->RebuildWheel();
+}
+
+/**
+ * Dump the table size, the probe lengths and the timing wheel occupancy.
+ * @param buffer The output buffer.
+ * @param last The last valid character of the output buffer.
+ * @return The position of the terminator in the output buffer.
+ */
+char *SignalSpeedStore::DumpStats(char *buffer, const char *last) const
+{
+	const size_t mask = this->table.size() - 1;
+	size_t total_probe = 0;
+	size_t longest_probe = 0;
+	size_t cluster = 0;
+	size_t longest_cluster = 0;
+	for (size_t i = 0; i < this->table.size(); i++) {
+		const Entry &entry = this->table[i];
+		if (!entry.used) {
+			cluster = 0;
+			continue;
+		}
+		cluster++;
+		longest_cluster = std::max(longest_cluster, cluster);
+		const size_t probe = ((i - this->GetHomeIndex(entry.key)) & mask) + 1;
+		total_probe += probe;
+		longest_probe = std::max(longest_probe, probe);
+	}
+
+	size_t expiries = 0;
+	size_t outdated = 0;
+	size_t longest_slot = 0;
+	for (const std::vector<Expiry> &slot : this->wheel) {
+		expiries += slot.size();
+		longest_slot = std::max(longest_slot, slot.size());
+		for (const Expiry &expiry : slot) {
+			const SignalSpeedValue *value = this->Find(expiry.key);
+			if (value == nullptr || value->time_stamp != expiry.time_stamp) outdated++;
+		}
+	}
+
+	buffer += seprintf(buffer, last, "Signal speeds: %u entries, table size: %u (%u%% used)\n",
+			(uint)this->count, (uint)this->table.size(), (uint)(this->count * 100 / this->table.size()));
+	buffer += seprintf(buffer, last, "  Probe length: average: %.2f, longest: %u, longest cluster: %u\n",
+			this->count > 0 ? (double)total_probe / this->count : 0.0, (uint)longest_probe, (uint)longest_cluster);
+	buffer += seprintf(buffer, last, "  Timing wheel: %u expiries (%u outdated), longest slot: %u, expired until: " OTTD_PRINTF64 "\n",
+			(uint)expiries, (uint)outdated, (uint)longest_slot, this->expired_until);
+	return buffer;
+}
+
+void DumpSignalSpeedStats(char *b, const char *last)
+{
+	_signal_speeds.DumpStats(b, last);
+}
@@ -14,7 +14,7 @@
 #include "track_type.h"
 #include "tile_type.h"
 
-#include <unordered_map>
+#include <vector>
 
 struct SignalSpeedKey
 {
@@ -36,18 +36,71 @@ struct SignalSpeedValue
 	DateTicksScaled time_stamp;
 };
 
-struct SignalSpeedKeyHashFunc
-{
-	std::size_t operator() (const SignalSpeedKey &key) const
-	{
-		const std::size_t h1 = std::hash<TileIndex>()(key.signal_tile);
-		const std::size_t h2 = std::hash<Trackdir>()(key.last_passing_train_dir);
-		const std::size_t h3 = std::hash<Track>()(key.signal_track);
+/**
+ * Store of the speeds of the last trains which passed signals.
+ * The entries are kept in an open addressing hash table with linear probing.
+ * Every entry is also registered in the slot of a timing wheel for its time stamp,
+ * so expired entries are found by visiting the slots whose time has passed, instead of the whole table.
+ */
+class SignalSpeedStore {
+	static const uint WHEEL_SLOT_BITS = 6;             ///< Number of bits of the time span of a wheel slot, in scaled date ticks.
+	static const uint WHEEL_SLOTS = 64;                ///< Number of wheel slots, so the wheel turns in 4096 scaled date ticks.
+	static const uint MIN_TABLE_BITS = 10;             ///< Number of bits of the smallest hash table size.
+
+	/** An entry of the hash table. */
+	struct Entry {
+		SignalSpeedKey key;
+		SignalSpeedValue value;
+		bool used;
+	};
+
+	/** An expiry registered in the timing wheel, outdated when the entry has been erased or has a different time stamp. */
+	struct Expiry {
+		SignalSpeedKey key;
+		DateTicksScaled time_stamp;
+	};
+
+	std::vector<Entry> table;                          ///< The hash table, its size is a power of two.
+	uint table_bits = 0;                               ///< Number of bits of the hash table size.
+	size_t count = 0;                                  ///< Number of used entries.
+	std::vector<Expiry> wheel[WHEEL_SLOTS];            ///< Expiries of the entries, by the wheel slot of their time stamp.
+	DateTicksScaled expired_until = 0;                 ///< Entries with time stamps before this have been removed.
 
-		return (h1 ^ h2) ^ h3;
+	size_t GetHomeIndex(const SignalSpeedKey &key) const;
+	size_t FindIndex(const SignalSpeedKey &key) const;
+	void EraseIndex(size_t index);
+	void Resize(uint bits);
+	void AddExpiry(const SignalSpeedKey &key, DateTicksScaled time_stamp);
+	void RebuildWheel();
+
+public:
+	SignalSpeedStore() { this->Resize(MIN_TABLE_BITS); }
+
+	const SignalSpeedValue *Find(const SignalSpeedKey &key) const;
+	void Set(const SignalSpeedKey &key, const SignalSpeedValue &value);
+	void Erase(const SignalSpeedKey &key);
+	void Clear();
+	void ClearOutOfDate(DateTicksScaled now);
+	void AdjustTimeStamps(DateTicksScaled delta);
+
+	/** Get the number of entries. */
+	size_t Size() const { return this->count; }
+
+	/**
+	 * Call a function for every entry, in table order.
+	 * @param func The function, called with the key and the value.
+	 */
+	template <typename F>
+	void Iterate(F func) const
+	{
+		for (const Entry &entry : this->table) {
+			if (entry.used) func(entry.key, entry.value);
+		}
 	}
+
+	char *DumpStats(char *buffer, const char *last) const;
 };
 
-extern std::unordered_map<SignalSpeedKey, SignalSpeedValue, SignalSpeedKeyHashFunc> _signal_speeds;
+extern SignalSpeedStore _signal_speeds;
 
 #endif /* TRAIN_SPEED_ADAPTATION_H */
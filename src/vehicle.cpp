@@ -63,33 +63,35 @@
 #include "table/strings.h"
 
 #include <algorithm>
+#include <chrono>
+#include <functional>
 
 #include "safeguards.h"
 
-/* Number of bits in the hash to use from each vehicle coord */
-static const uint GEN_HASHX_BITS = 6;
-static const uint GEN_HASHY_BITS = 6;
+/* Range of the number of bits in the viewport hash to use from each vehicle coord.
+ * The hash is sized to cover the whole map up to the maximum, 9 = 512 x 512 buckets. */
+static const uint MIN_GEN_HASH_BITS = 6;
+static const uint MAX_GEN_HASH_BITS = 9;
 
 /* Size of each hash bucket */
 static const uint GEN_HASHX_BUCKET_BITS = 7;
 static const uint GEN_HASHY_BUCKET_BITS = 6;
 
-/* Compute hash for vehicle coord */
-#define GEN_HASHX(x)    GB((x), GEN_HASHX_BUCKET_BITS + ZOOM_LVL_SHIFT, GEN_HASHX_BITS)
-#define GEN_HASHY(y)   (GB((y), GEN_HASHY_BUCKET_BITS + ZOOM_LVL_SHIFT, GEN_HASHY_BITS) << GEN_HASHX_BITS)
-#define GEN_HASH(x, y) (GEN_HASHY(y) + GEN_HASHX(x))
+static uint _gen_hashx_bits; ///< Number of bits in the viewport hash used from the X coord.
+static uint _gen_hashy_bits; ///< Number of bits in the viewport hash used from the Y coord.
+static uint _gen_hashx_mask; ///< Mask to wrap-around buckets in X direction.
+static uint _gen_hashy_mask; ///< Mask to wrap-around buckets in Y direction.
 
-/* Maximum size until hash repeats */
-//static const int GEN_HASHX_SIZE = 1 << (GEN_HASHX_BUCKET_BITS + GEN_HASHX_BITS + ZOOM_LVL_SHIFT);
-//static const int GEN_HASHY_SIZE = 1 << (GEN_HASHY_BUCKET_BITS + GEN_HASHY_BITS + ZOOM_LVL_SHIFT);
-
-/* Increments to reach next bucket in hash table */
-//static const int GEN_HASHX_INC = 1;
-//static const int GEN_HASHY_INC = 1 << GEN_HASHX_BITS;
-
-/* Mask to wrap-around buckets */
-//static const uint GEN_HASHX_MASK =  (1 << GEN_HASHX_BITS) - 1;
-//static const uint GEN_HASHY_MASK = ((1 << GEN_HASHY_BITS) - 1) << GEN_HASHX_BITS;
+/**
+ * Compute the viewport hash for a vehicle coord.
+ * @param x X coord of the vehicle in the viewport.
+ * @param y Y coord of the vehicle in the viewport.
+ * @return The index of the bucket.
+ */
+static inline uint GenHash(int x, int y)
+{
+	return (GB(y, GEN_HASHY_BUCKET_BITS + ZOOM_LVL_SHIFT, _gen_hashy_bits) << _gen_hashx_bits) + GB(x, GEN_HASHX_BUCKET_BITS + ZOOM_LVL_SHIFT, _gen_hashx_bits);
+}
 
 VehicleID _new_vehicle_id;
 uint _returned_refit_capacity;        ///< Stores the capacity after a refit operation.
@@ -461,32 +463,54 @@ byte VehicleRandomBits()
 	return GB(Random(), 0, 8);
 }
 
-/* Size of the hash, 6 = 64 x 64, 7 = 128 x 128. Larger sizes will (in theory) reduce hash
- * lookup times at the expense of memory usage. */
-const int HASH_BITS = 7;
-const int HASH_SIZE = 1 << HASH_BITS;
-const int HASH_MASK = HASH_SIZE - 1;
-const int TOTAL_HASH_SIZE = 1 << (HASH_BITS * 2);
-const int TOTAL_HASH_MASK = TOTAL_HASH_SIZE - 1;
+/* Maximum size of the tile hash of a vehicle type, 18 = 512 x 512. The hash is sized to the map
+ * up to this size, so on smaller maps every tile has a bucket of its own. On larger maps a bucket
+ * is shared by tiles which are a multiple of the hash size apart. */
+static const uint MAX_TILE_HASH_BITS = 18;
+
+static uint _tile_hash_bits_x;  ///< Number of bits of the X coordinate of a tile used for the tile hash.
+static uint _tile_hash_bits_y;  ///< Number of bits of the Y coordinate of a tile used for the tile hash.
+static uint _tile_hash_mask_x;  ///< Mask of the X coordinate of a tile for the tile hash.
+static uint _tile_hash_mask_y;  ///< Mask of the Y coordinate of a tile for the tile hash.
+static std::vector<Vehicle *> _vehicle_tile_hash; ///< The tile hash, consecutively for each vehicle type with a position on the map.
 
-/* Resolution of the hash, 0 = 1*1 tile, 1 = 2*2 tiles, 2 = 4*4 tiles, etc.
- * Profiling results show that 0 is fastest. */
-const int HASH_RES = 0;
+/**
+ * Get the bucket of the tile hash for a tile.
+ * @param x X coordinate of the tile.
+ * @param y Y coordinate of the tile.
+ * @param type The vehicle type.
+ * @return The bucket.
+ */
+static inline Vehicle **GetVehicleTileHashBucket(uint x, uint y, VehicleType type)
+{
+	return &_vehicle_tile_hash[(((size_t)type << _tile_hash_bits_y | (y & _tile_hash_mask_y)) << _tile_hash_bits_x) | (x & _tile_hash_mask_x)];
+}
 
-static Vehicle *_vehicle_tile_hash[TOTAL_HASH_SIZE * 4];
+/** Size the tile hash to the current map. */
+static void InitializeVehicleTileHash()
+{
+	_tile_hash_bits_y = std::min(MapLogY(), MAX_TILE_HASH_BITS / 2);
+	_tile_hash_bits_x = std::min(MapLogX(), MAX_TILE_HASH_BITS - _tile_hash_bits_y);
+	_tile_hash_bits_y = std::min(MapLogY(), MAX_TILE_HASH_BITS - _tile_hash_bits_x);
+	_tile_hash_mask_x = (1 << _tile_hash_bits_x) - 1;
+	_tile_hash_mask_y = (1 << _tile_hash_bits_y) - 1;
+	_vehicle_tile_hash.assign((size_t)VEH_COMPANY_END << (_tile_hash_bits_x + _tile_hash_bits_y), nullptr);
+}
 
-static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
+static Vehicle *VehicleFromTileHash(uint xl, uint yl, uint xu, uint yu, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	for (int y = yl; ; y = (y + (1 << HASH_BITS)) & (HASH_MASK << HASH_BITS)) {
-		for (int x = xl; ; x = (x + 1) & HASH_MASK) {
-			Vehicle *v = _vehicle_tile_hash[((x + y) & TOTAL_HASH_MASK) + (TOTAL_HASH_SIZE * type)];
+	/* The area is at most a few tiles wide, but do not visit buckets twice when the hash is even smaller. */
+	if (xu - xl >= _tile_hash_mask_x) xu = xl + _tile_hash_mask_x;
+	if (yu - yl >= _tile_hash_mask_y) yu = yl + _tile_hash_mask_y;
+
+	for (uint y = yl; y <= yu; y++) {
+		for (uint x = xl; x <= xu; x++) {
+			Vehicle *v = *GetVehicleTileHashBucket(x, y, type);
 			for (; v != nullptr; v = v->hash_tile_next) {
 				Vehicle *a = proc(v, data);
 				if (find_first && a != nullptr) return a;
 			}
-			if (x == xu) break;
 		}
-		if (y == yu) break;
 	}
 
 	return nullptr;
@@ -508,15 +532,33 @@ Vehicle *VehicleFromPosXY(int x, int y, VehicleType type, void *data, VehicleFro
 {
 	const int COLL_DIST = 6;
 
-	/* Hash area to scan is from xl,yl to xu,yu */
-	int xl = GB((x - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int xu = GB((x + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int yl = GB((y - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
-	int yu = GB((y + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
+	/* Tile area to scan is from xl,yl to xu,yu */
+	uint xl = std::max(x - COLL_DIST, 0) / TILE_SIZE;
+	uint xu = std::max(x + COLL_DIST, 0) / TILE_SIZE;
+	uint yl = std::max(y - COLL_DIST, 0) / TILE_SIZE;
+	uint yu = std::max(y + COLL_DIST, 0) / TILE_SIZE;
 
 	return VehicleFromTileHash(xl, yl, xu, yu, type, data, proc, find_first);
 }
 
+/**
+ * Helper function for FindVehicleOnPosXYArea.
+ * @note Do not call this function directly!
+ * @param xl   The lowest X location on the map
+ * @param yl   The lowest Y location on the map
+ * @param xu   The highest X location on the map
+ * @param yu   The highest Y location on the map
+ * @param data Arbitrary data passed to proc
+ * @param proc The proc that determines whether a vehicle will be "found".
+ * @param find_first Whether to return on the first found or iterate over
+ *                   all vehicles
+ * @return the best matching or first vehicle (depending on find_first).
+ */
+Vehicle *VehicleFromPosXYArea(int xl, int yl, int xu, int yu, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
+{
+	return VehicleFromTileHash(std::max(xl, 0) / TILE_SIZE, std::max(yl, 0) / TILE_SIZE, std::max(xu, 0) / TILE_SIZE, std::max(yu, 0) / TILE_SIZE, type, data, proc, find_first);
+}
+
 /**
  * Helper function for FindVehicleOnPos/HasVehicleOnPos.
  * @note Do not call this function directly!
@@ -529,10 +571,7 @@ Vehicle *VehicleFromPosXY(int x, int y, VehicleType type, void *data, VehicleFro
  */
 Vehicle *VehicleFromPos(TileIndex tile, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	int x = GB(TileX(tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(tile), HASH_RES, HASH_BITS) << HASH_BITS;
-
-	Vehicle *v = _vehicle_tile_hash[((x + y) & TOTAL_HASH_MASK) + (TOTAL_HASH_SIZE * type)];
+	Vehicle *v = *GetVehicleTileHashBucket(TileX(tile), TileY(tile), type);
 	for (; v != nullptr; v = v->hash_tile_next) {
 		if (v->tile != tile) continue;
 
@@ -831,9 +870,7 @@ void UpdateVehicleTileHash(Vehicle *v, bool remove)
 	if (remove || HasBit(v->subtype, GVSF_VIRTUAL)) {
 		new_hash = nullptr;
 	} else {
-		int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-		int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-		new_hash = &_vehicle_tile_hash[((x + y) & TOTAL_HASH_MASK) + (TOTAL_HASH_SIZE * v->type)];
+		new_hash = GetVehicleTileHashBucket(TileX(v->tile), TileY(v->tile), v->type);
 	}
 
 	if (old_hash == new_hash) return;
@@ -860,12 +897,31 @@ bool ValidateVehicleTileHash(const Vehicle *v)
 {
 	if ((v->type == VEH_TRAIN && Train::From(v)->IsVirtual()) || v->type >= VEH_COMPANY_END) return v->hash_tile_current == nullptr;
 
-	int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-	return v->hash_tile_current == &_vehicle_tile_hash[((x + y) & TOTAL_HASH_MASK) + (TOTAL_HASH_SIZE * v->type)];
+	return v->hash_tile_current == GetVehicleTileHashBucket(TileX(v->tile), TileY(v->tile), v->type);
 }
 
-static Vehicle *_vehicle_viewport_hash[1 << (GEN_HASHX_BITS + GEN_HASHY_BITS)];
+static std::vector<Vehicle *> _vehicle_viewport_hash;
+
+/**
+ * Size the viewport hash so it covers the current map, as far as the maximum size allows.
+ * In both directions a bucket covers the extent of four tile diagonals at the default zoom level.
+ */
+static void InitializeVehicleViewportHash()
+{
+	uint bits = Clamp<uint>(FindLastBit(std::max<uint>((MapSizeX() + MapSizeY()) / 4, 2) - 1) + 1, MIN_GEN_HASH_BITS, MAX_GEN_HASH_BITS);
+	_gen_hashx_bits = bits;
+	_gen_hashy_bits = bits;
+	_gen_hashx_mask = (1 << _gen_hashx_bits) - 1;
+	_gen_hashy_mask = (1 << _gen_hashy_bits) - 1;
+
+	size_t size = (size_t)1 << (_gen_hashx_bits + _gen_hashy_bits);
+	if (_vehicle_viewport_hash.size() == size) {
+		/* Keep the storage, vehicles may still refer to their old bucket. */
+		std::fill(_vehicle_viewport_hash.begin(), _vehicle_viewport_hash.end(), nullptr);
+	} else {
+		_vehicle_viewport_hash.assign(size, nullptr);
+	}
+}
 
 static void UpdateVehicleViewportHash(Vehicle *v, int x, int y)
 {
@@ -873,8 +929,8 @@ static void UpdateVehicleViewportHash(Vehicle *v, int x, int y)
 	int old_x = v->coord.left;
 	int old_y = v->coord.top;
 
-	new_hash = (x == INVALID_COORD) ? nullptr : &_vehicle_viewport_hash[GEN_HASH(x, y)];
-	old_hash = (old_x == INVALID_COORD) ? nullptr : &_vehicle_viewport_hash[GEN_HASH(old_x, old_y)];
+	new_hash = (x == INVALID_COORD) ? nullptr : &_vehicle_viewport_hash[GenHash(x, y)];
+	old_hash = (old_x == INVALID_COORD) ? nullptr : &_vehicle_viewport_hash[GenHash(old_x, old_y)];
 
 	if (old_hash == new_hash) return;
 
@@ -905,8 +961,8 @@ static void UpdateVehicleViewportHashDeferred(Vehicle *v, int x, int y)
 	int old_x = v->coord.left;
 	int old_y = v->coord.top;
 
-	int new_hash = (x == INVALID_COORD) ? INVALID_COORD : GEN_HASH(x, y);
-	int old_hash = (old_x == INVALID_COORD) ? INVALID_COORD : GEN_HASH(old_x, old_y);
+	int new_hash = (x == INVALID_COORD) ? INVALID_COORD : GenHash(x, y);
+	int old_hash = (old_x == INVALID_COORD) ? INVALID_COORD : GenHash(old_x, old_y);
 
 	if (new_hash != old_hash) {
 		_viewport_hash_deferred.push_back({ v, new_hash, old_hash });
@@ -939,8 +995,9 @@ static void ProcessDeferredUpdateVehicleViewportHashes()
 void ResetVehicleHash()
 {
 	for (Vehicle *v : Vehicle::Iterate()) { v->hash_tile_current = nullptr; }
-	memset(_vehicle_viewport_hash, 0, sizeof(_vehicle_viewport_hash));
-	memset(_vehicle_tile_hash, 0, sizeof(_vehicle_tile_hash));
+	_viewport_hash_deferred.clear();
+	InitializeVehicleViewportHash();
+	InitializeVehicleTileHash();
 }
 
 void ResetVehicleColourMap()
@@ -1735,28 +1792,28 @@ struct ViewportHashBound {
 static const int VHB_BASE_MARGIN = 70;
 
 static ViewportHashBound GetViewportHashBound(int l, int r, int t, int b, int x_margin, int y_margin) {
-	int xl = (l - ((VHB_BASE_MARGIN + x_margin) * ZOOM_LVL_BASE)) >> (7 + ZOOM_LVL_SHIFT);
-	int xu = (r + (x_margin * ZOOM_LVL_BASE))                 >> (7 + ZOOM_LVL_SHIFT);
+	int xl = (l - ((VHB_BASE_MARGIN + x_margin) * ZOOM_LVL_BASE)) >> (GEN_HASHX_BUCKET_BITS + ZOOM_LVL_SHIFT);
+	int xu = (r + (x_margin * ZOOM_LVL_BASE))                 >> (GEN_HASHX_BUCKET_BITS + ZOOM_LVL_SHIFT);
 	/* compare after shifting instead of before, so that lower bits don't affect comparison result */
-	if (xu - xl < (1 << 6)) {
-		xl &= 0x3F;
-		xu &= 0x3F;
+	if (xu - xl <= (int)_gen_hashx_mask) {
+		xl &= _gen_hashx_mask;
+		xu &= _gen_hashx_mask;
 	} else {
 		/* scan whole hash row */
 		xl = 0;
-		xu = 0x3F;
+		xu = _gen_hashx_mask;
 	}
 
-	int yl = (t - ((VHB_BASE_MARGIN + y_margin) * ZOOM_LVL_BASE)) >> (6 + ZOOM_LVL_SHIFT);
-	int yu = (b + (y_margin * ZOOM_LVL_BASE))                 >> (6 + ZOOM_LVL_SHIFT);
+	int yl = (t - ((VHB_BASE_MARGIN + y_margin) * ZOOM_LVL_BASE)) >> (GEN_HASHY_BUCKET_BITS + ZOOM_LVL_SHIFT);
+	int yu = (b + (y_margin * ZOOM_LVL_BASE))                 >> (GEN_HASHY_BUCKET_BITS + ZOOM_LVL_SHIFT);
 	/* compare after shifting instead of before, so that lower bits don't affect comparison result */
-	if (yu - yl < (1 << 6)) {
-		yl = (yl & 0x3F) << 6;
-		yu = (yu & 0x3F) << 6;
+	if (yu - yl <= (int)_gen_hashy_mask) {
+		yl &= _gen_hashy_mask;
+		yu &= _gen_hashy_mask;
 	} else {
 		/* scan whole column */
 		yl = 0;
-		yu = 0x3F << 6;
+		yu = _gen_hashy_mask;
 	}
 	return { xl, xu, yl, yu };
 };
@@ -1779,9 +1836,9 @@ void ViewportAddVehiclesIntl(DrawPixelInfo *dpi)
 	const int ut = t - (MAX_VEHICLE_PIXEL_Y * ZOOM_LVL_BASE);
 	const int ub = b + (MAX_VEHICLE_PIXEL_Y * ZOOM_LVL_BASE);
 
-	for (int y = vhb.yl;; y = (y + (1 << 6)) & (0x3F << 6)) {
-		for (int x = vhb.xl;; x = (x + 1) & 0x3F) {
-			const Vehicle *v = _vehicle_viewport_hash[x + y]; // already masked & 0xFFF
+	for (int y = vhb.yl;; y = (y + 1) & _gen_hashy_mask) {
+		for (int x = vhb.xl;; x = (x + 1) & _gen_hashx_mask) {
+			const Vehicle *v = _vehicle_viewport_hash[(y << _gen_hashx_bits) + x]; // already masked
 
 			while (v != nullptr) {
 				if (v->IsDrawn()) {
@@ -1847,29 +1904,33 @@ void ViewportMapDrawVehicles(DrawPixelInfo *dpi, Viewport *vp)
 	/* The hash area to scan */
 	const ViewportHashBound vhb = GetViewportHashBound(l, r, t, b, 0, 0);
 
+	/* One bit per bucket, rows of buckets start at a new word. */
+	const uint words_per_row = CeilDiv(_gen_hashx_mask + 1, 64);
+	std::vector<uint64> &done_hash_bits = vp->map_draw_vehicles_cache.done_hash_bits;
+	if (done_hash_bits.size() != (size_t)words_per_row << _gen_hashy_bits) done_hash_bits.assign((size_t)words_per_row << _gen_hashy_bits, 0);
+
 	Blitter *blitter = BlitterFactory::GetCurrentBlitter();
-	for (int y = vhb.yl;; y = (y + (1 << 6)) & (0x3F << 6)) {
-		if (vp->map_draw_vehicles_cache.done_hash_bits[y >> 6] != UINT64_MAX) {
-			for (int x = vhb.xl;; x = (x + 1) & 0x3F) {
-				if (!HasBit(vp->map_draw_vehicles_cache.done_hash_bits[y >> 6], x)) {
-					SetBit(vp->map_draw_vehicles_cache.done_hash_bits[y >> 6], x);
-					const Vehicle *v = _vehicle_viewport_hash[x + y]; // already masked & 0xFFF
-
-					while (v != nullptr) {
-						if (!(v->vehstatus & (VS_HIDDEN | VS_UNCLICKABLE)) && (v->type != VEH_EFFECT)) {
-							Point pt = RemapCoords(v->x_pos, v->y_pos, v->z_pos);
-							if (pt.x >= l && pt.x < r && pt.y >= t && pt.y < b) {
-								const int pixel_x = UnScaleByZoomLower(pt.x - l, dpi->zoom);
-								const int pixel_y = UnScaleByZoomLower(pt.y - t, dpi->zoom);
-								vp->map_draw_vehicles_cache.vehicle_pixels[pixel_x + (pixel_y) * vp->width] = true;
-							}
+	for (int y = vhb.yl;; y = (y + 1) & _gen_hashy_mask) {
+		uint64 *row_done_bits = done_hash_bits.data() + y * words_per_row;
+		for (int x = vhb.xl;; x = (x + 1) & _gen_hashx_mask) {
+			if (!HasBit(row_done_bits[x >> 6], x & 63)) {
+				SetBit(row_done_bits[x >> 6], x & 63);
+				const Vehicle *v = _vehicle_viewport_hash[(y << _gen_hashx_bits) + x]; // already masked
+
+				while (v != nullptr) {
+					if (!(v->vehstatus & (VS_HIDDEN | VS_UNCLICKABLE)) && (v->type != VEH_EFFECT)) {
+						Point pt = RemapCoords(v->x_pos, v->y_pos, v->z_pos);
+						if (pt.x >= l && pt.x < r && pt.y >= t && pt.y < b) {
+							const int pixel_x = UnScaleByZoomLower(pt.x - l, dpi->zoom);
+							const int pixel_y = UnScaleByZoomLower(pt.y - t, dpi->zoom);
+							vp->map_draw_vehicles_cache.vehicle_pixels[pixel_x + (pixel_y) * vp->width] = true;
 						}
-						v = v->hash_viewport_next;
 					}
+					v = v->hash_viewport_next;
 				}
-
-				if (x == vhb.xu) break;
 			}
+
+			if (x == vhb.xu) break;
 		}
 
 		if (y == vhb.yu) break;
@@ -4326,6 +4387,65 @@ void DumpVehicleStats(char *buffer, const char *last)
 	}
 }
 
+/**
+ * Dump the occupancy of the vehicle tile hash, and time the position lookups done by
+ * signals, collision checks, level crossings and the like for all vehicles on the map.
+ * @param buffer The buffer to write to.
+ * @param last The last character of the buffer.
+ * @param iterations How many times to look up the position of every vehicle.
+ */
+void DumpVehicleTileHashStats(char *buffer, const char *last, uint iterations)
+{
+	static const char * const type_names[] = { "train", "road", "ship", "aircraft" };
+	static_assert(lengthof(type_names) == VEH_COMPANY_END);
+
+	buffer += seprintf(buffer, last, "Tile hash: %u x %u buckets per vehicle type, %u x %u tiles per bucket\n",
+			_tile_hash_mask_x + 1, _tile_hash_mask_y + 1, MapSizeX() >> _tile_hash_bits_x, MapSizeY() >> _tile_hash_bits_y);
+
+	const size_t buckets = (size_t)1 << (_tile_hash_bits_x + _tile_hash_bits_y);
+	for (uint type = 0; type < VEH_COMPANY_END; type++) {
+		uint vehicles = 0;
+		uint used = 0;
+		uint longest = 0;
+		for (size_t i = 0; i < buckets; i++) {
+			uint length = 0;
+			for (const Vehicle *v = _vehicle_tile_hash[type * buckets + i]; v != nullptr; v = v->hash_tile_next) length++;
+			vehicles += length;
+			if (length > 0) used++;
+			longest = std::max(longest, length);
+		}
+		buffer += seprintf(buffer, last, "  %8s: %6u vehicles in %6u buckets, longest chain: %u\n", type_names[type], vehicles, used, longest);
+	}
+
+	std::vector<const Vehicle *> vehicles;
+	for (const Vehicle *v : Vehicle::Iterate()) {
+		if (v->hash_tile_current != nullptr) vehicles.push_back(v);
+	}
+	if (vehicles.empty() || iterations == 0) return;
+
+	auto count_proc = [](Vehicle *v, void *data) -> Vehicle * {
+		(*static_cast<uint64 *>(data))++;
+		return nullptr;
+	};
+	auto time_lookups = [&](const char *name, std::function<void(const Vehicle *, uint64 *)> lookup) {
+		uint64 visited = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (uint i = 0; i < iterations; i++) {
+			for (const Vehicle *v : vehicles) lookup(v, &visited);
+		}
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		uint64 lookups = (uint64)vehicles.size() * iterations;
+		buffer += seprintf(buffer, last, "%s: %u lookups, " OTTD_PRINTF64 " ns per lookup, %.2f vehicles per lookup\n",
+				name, (uint)lookups, (int64)(ns / lookups), (double)visited / lookups);
+	};
+	time_lookups("By tile", [&](const Vehicle *v, uint64 *visited) {
+		FindVehicleOnPos(v->tile, v->type, visited, count_proc);
+	});
+	time_lookups("By position", [&](const Vehicle *v, uint64 *visited) {
+		FindVehicleOnPosXY(v->x_pos, v->y_pos, v->type, visited, count_proc);
+	});
+}
+
 void ShiftVehicleDates(int interval)
 {
 	for (Vehicle *v : Vehicle::Iterate()) {
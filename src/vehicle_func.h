@@ -98,6 +98,23 @@ inline void FindVehicleOnPosXY(int x, int y, VehicleType type, void *data, Vehic
 	VehicleFromPosXY(x, y, type, data, proc, false);
 }
 
+/**
+ * Find vehicles on the tiles of an area of pixel coordinates, and call
+ * the proc for each of them, like #FindVehicleOnPosXY. Only vehicles on
+ * the tiles of the area are visited, not those around it.
+ * @param xl   The lowest X location on the map
+ * @param yl   The lowest Y location on the map
+ * @param xu   The highest X location on the map
+ * @param yu   The highest Y location on the map
+ * @param data Arbitrary data passed to proc
+ * @param proc The proc that determines whether a vehicle will be "found".
+ */
+inline void FindVehicleOnPosXYArea(int xl, int yl, int xu, int yu, VehicleType type, void *data, VehicleFromPosProc *proc)
+{
+	extern Vehicle *VehicleFromPosXYArea(int xl, int yl, int xu, int yu, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first);
+	VehicleFromPosXYArea(xl, yl, xu, yu, type, data, proc, false);
+}
+
 /**
  * Checks whether a vehicle in on a specific location. It will call proc for
  * vehicles until it returns non-nullptr.
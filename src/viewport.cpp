@@ -381,7 +381,7 @@ void ClearViewportLandPixelCache(Viewport *vp)
 void ClearViewportCache(Viewport *vp)
 {
 	if (vp->zoom >= ZOOM_LVL_DRAW_MAP) {
-		memset(vp->map_draw_vehicles_cache.done_hash_bits, 0, sizeof(vp->map_draw_vehicles_cache.done_hash_bits));
+		vp->map_draw_vehicles_cache.done_hash_bits.assign(vp->map_draw_vehicles_cache.done_hash_bits.size(), 0);
 		vp->map_draw_vehicles_cache.vehicle_pixels.assign(vp->map_draw_vehicles_cache.vehicle_pixels.size(), false);
 	}
 }
@@ -3505,7 +3505,7 @@ void UpdateViewportSizeZoom(Viewport *vp)
 	vp->dirty_blocks.assign(size, false);
 	UpdateViewportDirtyBlockLeftMargin(vp);
 	if (vp->zoom >= ZOOM_LVL_DRAW_MAP) {
-		memset(vp->map_draw_vehicles_cache.done_hash_bits, 0, sizeof(vp->map_draw_vehicles_cache.done_hash_bits));
+		vp->map_draw_vehicles_cache.done_hash_bits.assign(vp->map_draw_vehicles_cache.done_hash_bits.size(), 0);
 		vp->map_draw_vehicles_cache.vehicle_pixels.assign(vp->width * vp->height, false);
 
 		if (BlitterFactory::GetCurrentBlitter()->GetScreenDepth() == 32) {
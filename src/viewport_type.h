@@ -31,7 +31,7 @@ enum ViewportMapType {
 };
 
 struct ViewPortMapDrawVehiclesCache {
-	uint64 done_hash_bits[64];
+	std::vector<uint64> done_hash_bits; ///< Buckets of the vehicle viewport hash which have been drawn, one bit per bucket
 	std::vector<bool> vehicle_pixels;
 };
 